@@ -0,0 +1,430 @@
+#include "GameBenchmark.hpp"
+#include "MicroBenchmark.hpp"
+#include "app_config.h"
+#include "render_stats.h"
+#include "alloc_tracker.h"
+#include "mem_policy.h"
+#include "DeferredDeleter.hpp"
+#include "TetrisAI.hpp"
+#include "Expectimax2048.hpp"
+#include "MineGenerator.hpp"
+#include "Minesweeper.hpp"
+#include "esp_app_desc.h"
+#include "esp_heap_caps.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include <cstdio>
+#include <memory>
+
+static const char *TAG = "GameBenchmark";
+
+// Frames rendered after stop() so deferred deletions are part of the teardown, not the next game
+static const int TEARDOWN_FRAMES = 3;
+
+// Keys cycled through in scripted mode, one every BENCH_INPUT_INTERVAL frames
+static const uint32_t SCRIPT[] = {
+    LV_KEY_ENTER, LV_KEY_RIGHT, LV_KEY_RIGHT, LV_KEY_UP, LV_KEY_DOWN,
+    LV_KEY_LEFT, LV_KEY_LEFT, LV_KEY_UP, LV_KEY_ENTER, LV_KEY_DOWN,
+};
+static const uint32_t RANDOM_KEYS[] = {
+    LV_KEY_LEFT, LV_KEY_RIGHT, LV_KEY_UP, LV_KEY_DOWN, LV_KEY_ENTER,
+};
+
+uint32_t GameBenchmark::virtualMs_ = 0;
+int64_t GameBenchmark::renderStart_ = 0;
+uint32_t GameBenchmark::renderUs_ = 0;
+
+GameBenchmark& GameBenchmark::instance() {
+    static GameBenchmark inst;
+    return inst;
+}
+
+void GameBenchmark::start() {
+    // Same core, stack and priority as the regular LVGL task
+    xTaskCreatePinnedToCore(taskEntry, "GameBenchmark", 65535, this, 15, nullptr, 1);
+}
+
+void GameBenchmark::taskEntry(void* arg) {
+    static_cast<GameBenchmark*>(arg)->runAll();
+    vTaskDelete(nullptr);
+}
+
+uint32_t GameBenchmark::virtualTick() {
+    return virtualMs_;
+}
+
+void GameBenchmark::displayEventCallback(lv_event_t* e) {
+    switch (lv_event_get_code(e)) {
+        case LV_EVENT_REFR_START:
+            renderStart_ = esp_timer_get_time();
+            break;
+        case LV_EVENT_REFR_READY:
+            renderUs_ += static_cast<uint32_t>(esp_timer_get_time() - renderStart_);
+            break;
+        default:
+            break;
+    }
+}
+
+void GameBenchmark::headlessFlushCallback(lv_display_t* display, const lv_area_t* area, uint8_t* pxMap) {
+    render_stats_on_flush(area, pxMap);
+    lv_display_flush_ready(display);
+}
+
+void GameBenchmark::runAll() {
+    lv_display_t* display = lv_display_get_default();
+
+    ESP_LOGI(TAG, "Benchmark started: %d frames per game, %s input", BENCH_FRAMES,
+             BENCH_RANDOM_INPUT ? "random" : "scripted");
+
+    // Game logs would otherwise dominate the measured time
+    esp_log_level_set("*", ESP_LOG_WARN);
+
+    // Before the first frame, the mock panel transfers must not end up in a render stats session
+    if (BENCH_MICRO) {
+        MicroBenchmark::instance().run();
+    }
+
+    lv_tick_set_cb(virtualTick);
+    lv_display_add_event_cb(display, displayEventCallback, LV_EVENT_REFR_START, nullptr);
+    lv_display_add_event_cb(display, displayEventCallback, LV_EVENT_REFR_READY, nullptr);
+    if (BENCH_HEADLESS_FLUSH) {
+        lv_display_set_flush_cb(display, headlessFlushCallback);
+    }
+
+    idleScreen_ = lv_obj_create(nullptr);
+    lv_screen_load(idleScreen_);
+    lv_timer_handler();
+
+    const auto& games = GameRegistry::instance().available();
+    results_.clear();
+    results_.reserve(games.size());
+    for (const auto& factory : games) {
+        results_.emplace_back();
+        runGame(factory, results_.back());
+    }
+    if (BENCH_AI_PIECES > 0) {
+        runTetrisAi();
+    }
+    if (BENCH_2048_MOVES > 0) {
+        run2048Search();
+    }
+    if (BENCH_MINES_BOARDS > 0) {
+        runMineSolver();
+    }
+    render_stats_begin_session("Benchmark");
+    alloc_tracker_begin_session("Benchmark");
+    mem_policy_begin_session("Benchmark");
+
+    esp_log_level_set("*", ESP_LOG_INFO);
+    printJson();
+    ESP_LOGI(TAG, "Benchmark finished, set APP_BENCHMARK_MODE to 0 to start the console");
+}
+
+void GameBenchmark::runGame(const GameFactory& factory, Result& result) {
+    result.name = factory.name;
+    rng_ = BENCH_SEED;
+
+    render_stats_begin_session(factory.name.c_str());
+    alloc_tracker_begin_session(factory.name.c_str());
+    mem_policy_begin_session(factory.name.c_str());
+
+    lv_mem_monitor_t mem;
+    uint32_t heapFreeBefore = heap_caps_get_free_size(MALLOC_CAP_DEFAULT);
+    uint32_t heapFreeMin = heapFreeBefore;
+    uint32_t allocsBefore;
+    uint64_t bytesBefore;
+    alloc_tracker_get_totals(&allocsBefore, &bytesBefore);
+
+    auto game = factory.create();
+    game->run();
+
+    // Heap allocations only, LVGL allocations are reported via lv_mem_monitor and mem_policy
+    uint32_t allocsMark;
+    uint64_t bytesMark;
+    alloc_tracker_get_totals(&allocsMark, &bytesMark);
+    result.setupAllocs = allocsMark - allocsBefore;
+
+    uint64_t tickSum = 0;
+    uint64_t renderSum = 0;
+
+    for (uint32_t frame = 0; frame < BENCH_FRAMES; frame++) {
+        uint32_t key = nextKey(frame);
+        if (key) {
+            game->handleKey(key);
+        }
+
+        int64_t t0 = esp_timer_get_time();
+        game->update();
+        int64_t t1 = esp_timer_get_time();
+
+        virtualMs_ += BENCH_FRAME_MS;
+        renderUs_ = 0;
+        lv_timer_handler();
+        int64_t t2 = esp_timer_get_time();
+
+        // Game timers run inside lv_timer_handler, everything outside the refresh counts as tick
+        uint32_t handlerUs = static_cast<uint32_t>(t2 - t1);
+        uint32_t tickUs = static_cast<uint32_t>(t1 - t0) + (handlerUs > renderUs_ ? handlerUs - renderUs_ : 0);
+
+        tickSum += tickUs;
+        renderSum += renderUs_;
+        if (tickUs > result.tickMaxUs) result.tickMaxUs = tickUs;
+        if (renderUs_ > result.renderMaxUs) result.renderMaxUs = renderUs_;
+
+        uint32_t objects = liveObjects();
+        if (objects > result.objectsMax) result.objectsMax = objects;
+
+        uint32_t heapFree = heap_caps_get_free_size(MALLOC_CAP_DEFAULT);
+        if (heapFree < heapFreeMin) heapFreeMin = heapFree;
+
+        lv_mem_monitor(&mem);
+        uint32_t lvUsed = mem.total_size - mem.free_size;
+        if (lvUsed > result.lvMemPeakBytes) result.lvMemPeakBytes = lvUsed;
+    }
+
+    result.frames = BENCH_FRAMES;
+    result.tickAvgUs = static_cast<uint32_t>(tickSum / BENCH_FRAMES);
+    result.renderAvgUs = static_cast<uint32_t>(renderSum / BENCH_FRAMES);
+    uint32_t allocsEnd;
+    uint64_t bytesEnd;
+    alloc_tracker_get_totals(&allocsEnd, &bytesEnd);
+    result.frameAllocs = allocsEnd - allocsMark;
+    result.frameAllocBytes = bytesEnd - bytesMark;
+    result.heapPeakBytes = heapFreeBefore - heapFreeMin;
+    result.objectsEnd = liveObjects();
+    lv_mem_monitor(&mem);
+    result.lvMemEndBytes = mem.total_size - mem.free_size;
+
+    mem_tier_stats_t tiers[MEM_TIER_COUNT];
+    mem_policy_get_stats(tiers);
+    result.lvSramPeakBytes = tiers[MEM_TIER_INTERNAL].peak_bytes;
+    result.lvPsramPeakBytes = tiers[MEM_TIER_PSRAM].peak_bytes;
+
+    render_stats_t stats;
+    render_stats_get_session(&stats);
+    if (stats.frames > 0) {
+        result.redrawnPxPerFrame = stats.redrawn_pixels / stats.frames;
+        result.txBytesPerFrame = static_cast<uint32_t>(stats.tx_bytes / stats.frames);
+    }
+
+    // Never delete the active screen from under LVGL
+    lv_screen_load(idleScreen_);
+    game->stop();
+    game.reset();
+    DeferredDeleter::instance().drain();
+    for (int i = 0; i < TEARDOWN_FRAMES; i++) {
+        virtualMs_ += BENCH_FRAME_MS;
+        lv_timer_handler();
+    }
+
+    ESP_LOGW(TAG, "%s: tick %lu us, render %lu us, %lu objects, %lu allocs",
+             result.name.c_str(), result.tickAvgUs, result.renderAvgUs,
+             result.objectsEnd, result.frameAllocs);
+}
+
+void GameBenchmark::runTetrisAi() {
+    TetrisBoard board;
+    TetrisAI ai;
+    aiResult_ = AiResult();
+    rng_ = BENCH_SEED;
+
+    // Same xorshift32 as the key input, the piece sequence only depends on BENCH_SEED
+    auto nextPiece = [this]() {
+        rng_ ^= rng_ << 13;
+        rng_ ^= rng_ >> 17;
+        rng_ ^= rng_ << 5;
+        return static_cast<TetrisBoard::Piece>(rng_ % TetrisBoard::PIECE_COUNT);
+    };
+
+    TetrisBoard::Piece current = nextPiece();
+    TetrisBoard::Piece next = nextPiece();
+
+    int64_t t0 = esp_timer_get_time();
+    for (uint32_t i = 0; i < BENCH_AI_PIECES; i++) {
+        TetrisAI::Placement p = ai.choose(board, current, next);
+        if (p.valid) {
+            board.place(current, p.rotation, p.x, p.y);
+            aiResult_.lines += __builtin_popcount(board.clearLines());
+        } else {
+            board.clear();
+            aiResult_.games++;
+        }
+        current = next;
+        next = nextPiece();
+    }
+    aiResult_.us = esp_timer_get_time() - t0;
+    aiResult_.pieces = BENCH_AI_PIECES;
+    aiResult_.searched = ai.searched();
+
+    ESP_LOGW(TAG, "TetrisAI: %lu pieces, %lu boards in %llu us, %lu lines",
+             aiResult_.pieces, aiResult_.searched, aiResult_.us, aiResult_.lines);
+}
+
+void GameBenchmark::run2048Search() {
+    searchResult_ = SearchResult();
+    if (!Board2048::initTables()) {
+        return;
+    }
+    Expectimax2048 search;
+    rng_ = BENCH_SEED;
+
+    // New tile from the same xorshift32, 2 with 0.9 and 4 with 0.1
+    auto addTile = [this](Board2048::Bits board) {
+        Board2048::Bits empty = Board2048::emptyMask(board);
+        rng_ ^= rng_ << 13;
+        rng_ ^= rng_ >> 17;
+        rng_ ^= rng_ << 5;
+        for (int i = rng_ % __builtin_popcountll(empty); i > 0; i--) {
+            empty &= empty - 1;
+        }
+        Board2048::Bits tile = (rng_ >> 8) % 10 ? 1 : 2;
+        return board | (tile << __builtin_ctzll(empty));
+    };
+
+    Board2048::Bits board = addTile(addTile(0));
+    uint32_t score = 0;
+
+    int64_t t0 = esp_timer_get_time();
+    for (uint32_t i = 0; i < BENCH_2048_MOVES; i++) {
+        Expectimax2048::Result r = search.think(board, esp_timer_get_time() + G2048_SEARCH_MS * 1000, G2048_MAX_DEPTH);
+        if (!r.valid) {
+            searchResult_.games++;
+            board = addTile(addTile(0));
+            score = 0;
+            continue;
+        }
+        searchResult_.depthSum += r.depth;
+        if (static_cast<uint32_t>(r.depth) > searchResult_.depthMax) {
+            searchResult_.depthMax = r.depth;
+        }
+        score += Board2048::moveScore(board, r.move);
+        board = addTile(Board2048::move(board, r.move));
+
+        uint32_t tile = 1u << Board2048::maxExponent(board);
+        if (tile > searchResult_.maxTile) {
+            searchResult_.maxTile = tile;
+        }
+        if (score > searchResult_.score) {
+            searchResult_.score = score;
+        }
+    }
+    searchResult_.us = esp_timer_get_time() - t0;
+    searchResult_.moves = BENCH_2048_MOVES;
+    searchResult_.evaluated = search.evaluated();
+
+    ESP_LOGW(TAG, "Expectimax2048: %lu moves, %lu boards in %llu us, max tile %lu",
+             searchResult_.moves, searchResult_.evaluated, searchResult_.us, searchResult_.maxTile);
+}
+
+void GameBenchmark::runMineSolver() {
+    minesResult_ = MinesResult();
+    const MinesweeperConfig& config = Minesweeper::EXPERT;
+    int x = config.gridWidth / 2;
+    int y = config.gridHeight / 2;
+
+    MineSolver solver;
+    solver.init(config.gridWidth, config.gridHeight);
+    CellBits mines;
+    mines.init(config.gridWidth, config.gridHeight);
+    auto rng = std::make_unique<std::mt19937>(BENCH_SEED);
+
+    // A deadline already passed tries exactly one board per call
+    int64_t t0 = esp_timer_get_time();
+    for (uint32_t i = 0; i < BENCH_MINES_BOARDS; i++) {
+        MineGenerator::Stats stats = MineGenerator::generate(solver, mines, config.mines, x, y, *rng, 0, nullptr);
+        minesResult_.boards += stats.boards;
+        minesResult_.solvable += stats.solvable;
+    }
+    minesResult_.us = esp_timer_get_time() - t0;
+
+    ESP_LOGW(TAG, "MineSolver: %lu boards, %lu without guessing in %llu us",
+             minesResult_.boards, minesResult_.solvable, minesResult_.us);
+}
+
+uint32_t GameBenchmark::nextKey(uint32_t frame) {
+    if (frame % BENCH_INPUT_INTERVAL != 0) {
+        return 0;
+    }
+
+    if (!BENCH_RANDOM_INPUT) {
+        uint32_t step = frame / BENCH_INPUT_INTERVAL;
+        return SCRIPT[step % (sizeof(SCRIPT) / sizeof(SCRIPT[0]))];
+    }
+
+    // xorshift32, same sequence for every game
+    rng_ ^= rng_ << 13;
+    rng_ ^= rng_ >> 17;
+    rng_ ^= rng_ << 5;
+    return RANDOM_KEYS[rng_ % (sizeof(RANDOM_KEYS) / sizeof(RANDOM_KEYS[0]))];
+}
+
+static uint32_t countObjects(lv_obj_t* obj) {
+    uint32_t count = 1;
+    uint32_t childCount = lv_obj_get_child_count(obj);
+    for (uint32_t i = 0; i < childCount; i++) {
+        count += countObjects(lv_obj_get_child(obj, i));
+    }
+    return count;
+}
+
+// Objects reachable from the active screen and the display layers
+uint32_t GameBenchmark::liveObjects() const {
+    lv_display_t* display = lv_display_get_default();
+    return countObjects(lv_display_get_screen_active(display)) +
+           countObjects(lv_display_get_layer_top(display)) +
+           countObjects(lv_display_get_layer_sys(display)) +
+           countObjects(lv_display_get_layer_bottom(display));
+}
+
+void GameBenchmark::printJson() const {
+    // Plain printf so the block can be cut out of the monitor output between the markers
+    printf("BENCH_JSON_BEGIN\n");
+    printf("{\"version\":\"%s\",\"frames\":%d,\"frame_ms\":%d,\"input\":\"%s\",\"seed\":%d,\"headless\":%d,\"games\":[\n",
+           esp_app_get_description()->version, BENCH_FRAMES, BENCH_FRAME_MS,
+           BENCH_RANDOM_INPUT ? "random" : "scripted", BENCH_SEED, BENCH_HEADLESS_FLUSH);
+
+    for (size_t i = 0; i < results_.size(); i++) {
+        const Result& r = results_[i];
+        uint32_t allocsX100 = static_cast<uint32_t>(static_cast<uint64_t>(r.frameAllocs) * 100 / r.frames);
+
+        printf("{\"name\":\"%s\",\"tick_us\":{\"avg\":%lu,\"max\":%lu},\"render_us\":{\"avg\":%lu,\"max\":%lu},"
+               "\"lv_objects\":{\"end\":%lu,\"max\":%lu},\"heap_allocs_setup\":%lu,\"heap_allocs_per_frame\":%lu.%02lu,"
+               "\"heap_alloc_bytes_per_frame\":%lu,\"heap_peak_bytes\":%lu,\"lv_mem_peak_bytes\":%lu,\"lv_mem_end_bytes\":%lu,"
+               "\"lv_sram_peak_bytes\":%lu,\"lv_psram_peak_bytes\":%lu,"
+               "\"redrawn_px_per_frame\":%lu,\"tx_bytes_per_frame\":%lu}%s\n",
+               r.name.c_str(), r.tickAvgUs, r.tickMaxUs, r.renderAvgUs, r.renderMaxUs,
+               r.objectsEnd, r.objectsMax, r.setupAllocs, allocsX100 / 100, allocsX100 % 100,
+               static_cast<uint32_t>(r.frameAllocBytes / r.frames), r.heapPeakBytes,
+               r.lvMemPeakBytes, r.lvMemEndBytes, r.lvSramPeakBytes, r.lvPsramPeakBytes, r.redrawnPxPerFrame, r.txBytesPerFrame,
+               i + 1 < results_.size() ? "," : "");
+    }
+
+    printf("]");
+    if (aiResult_.pieces > 0) {
+        uint32_t perSecond = aiResult_.us ? static_cast<uint32_t>(aiResult_.searched * 1000000ULL / aiResult_.us) : 0;
+        printf(",\"tetris_ai\":{\"pieces\":%lu,\"placements_searched\":%lu,\"us\":%llu,"
+               "\"placements_per_s\":%lu,\"lines\":%lu,\"games\":%lu}",
+               aiResult_.pieces, aiResult_.searched, aiResult_.us, perSecond, aiResult_.lines, aiResult_.games);
+    }
+    if (searchResult_.moves > 0) {
+        const SearchResult& r = searchResult_;
+        uint32_t perSecond = r.us ? static_cast<uint32_t>(r.evaluated * 1000000ULL / r.us) : 0;
+        uint32_t depthX100 = r.depthSum * 100 / r.moves;
+        printf(",\"g2048_search\":{\"moves\":%lu,\"budget_ms\":%d,\"depth_avg\":%lu.%02lu,\"depth_max\":%lu,"
+               "\"boards\":%lu,\"boards_per_s\":%lu,\"score\":%lu,\"max_tile\":%lu,\"games\":%lu}",
+               r.moves, G2048_SEARCH_MS, depthX100 / 100, depthX100 % 100, r.depthMax,
+               r.evaluated, perSecond, r.score, r.maxTile, r.games);
+    }
+    if (minesResult_.boards > 0) {
+        const MinesResult& r = minesResult_;
+        uint32_t perSecond = r.us ? static_cast<uint32_t>(r.boards * 1000000ULL / r.us) : 0;
+        printf(",\"mines_solver\":{\"size\":\"%dx%d/%d\",\"boards\":%lu,\"no_guess\":%lu,\"us\":%llu,\"boards_per_s\":%lu}",
+               Minesweeper::EXPERT.gridWidth, Minesweeper::EXPERT.gridHeight, Minesweeper::EXPERT.mines,
+               r.boards, r.solvable, r.us, perSecond);
+    }
+    printf("}\n");
+    printf("BENCH_JSON_END\n");
+}
@@ -0,0 +1,96 @@
+#pragma once
+
+#include "GameRegistry.hpp"
+#include "lvgl.h"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Runs every registered game for BENCH_FRAMES frames on a virtual LVGL clock,
+// feeds scripted or pseudo-random keys and prints the results as one JSON
+// document on UART. Enabled with APP_BENCHMARK_MODE in app_config.h, the menu
+// and the regular LVGL task are not started in that mode.
+class GameBenchmark {
+public:
+    static GameBenchmark& instance();
+
+    void start();
+
+private:
+    GameBenchmark() = default;
+
+    struct Result {
+        std::string name;
+        uint32_t frames = 0;
+        uint32_t tickAvgUs = 0;
+        uint32_t tickMaxUs = 0;
+        uint32_t renderAvgUs = 0;
+        uint32_t renderMaxUs = 0;
+        uint32_t objectsEnd = 0;
+        uint32_t objectsMax = 0;
+        uint32_t setupAllocs = 0;
+        uint32_t frameAllocs = 0;       // heap allocations during the measured frames
+        uint64_t frameAllocBytes = 0;
+        uint32_t heapPeakBytes = 0;     // lowest sampled free heap against the free heap before run()
+        uint32_t lvMemPeakBytes = 0;
+        uint32_t lvMemEndBytes = 0;
+        uint32_t lvSramPeakBytes = 0;
+        uint32_t lvPsramPeakBytes = 0;
+        uint32_t redrawnPxPerFrame = 0;
+        uint32_t txBytesPerFrame = 0;
+    };
+
+    // Tetris autoplayer without rendering, a CPU workload comparable between builds
+    struct AiResult {
+        uint32_t pieces = 0;
+        uint32_t searched = 0;      // boards evaluated
+        uint32_t lines = 0;
+        uint32_t games = 0;         // boards topped out and restarted
+        uint64_t us = 0;
+    };
+
+    // 2048 hint search playing on its own without rendering. The search runs to the
+    // G2048_SEARCH_MS deadline, so a faster build shows up as deeper searches.
+    struct SearchResult {
+        uint32_t moves = 0;
+        uint32_t evaluated = 0;     // boards evaluated
+        uint32_t depthSum = 0;
+        uint32_t depthMax = 0;
+        uint32_t score = 0;
+        uint32_t maxTile = 0;
+        uint32_t games = 0;         // boards without moves and restarted
+        uint64_t us = 0;
+    };
+
+    // Minesweeper no-guess solver on expert boards, first click in the middle
+    struct MinesResult {
+        uint32_t boards = 0;
+        uint32_t solvable = 0;      // cleared without guessing
+        uint64_t us = 0;
+    };
+
+    static void taskEntry(void* arg);
+    static uint32_t virtualTick();
+    static void displayEventCallback(lv_event_t* e);
+    static void headlessFlushCallback(lv_display_t* display, const lv_area_t* area, uint8_t* pxMap);
+
+    void runAll();
+    void runGame(const GameFactory& factory, Result& result);
+    void runTetrisAi();
+    void run2048Search();
+    void runMineSolver();
+    uint32_t nextKey(uint32_t frame);
+    uint32_t liveObjects() const;
+    void printJson() const;
+
+    std::vector<Result> results_;
+    AiResult aiResult_;
+    SearchResult searchResult_;
+    MinesResult minesResult_;
+    lv_obj_t* idleScreen_ = nullptr;
+    uint32_t rng_ = 0;
+
+    static uint32_t virtualMs_;
+    static int64_t renderStart_;
+    static uint32_t renderUs_;
+};
@@ -0,0 +1,30 @@
+#pragma once
+
+#include <cstdint>
+
+// Reference results of MicroBenchmark on the target board, one entry per case.
+// A case slower than ns by more than thresholdPct percent is flagged as a
+// regression. Refresh ns from the "name"/"ns" pairs of a known good run on the
+// reference board; ns 0 means no reference yet and the case is never flagged.
+struct MicroBaseline {
+    const char* name;
+    uint32_t ns;
+    uint32_t thresholdPct;
+};
+
+// The driver cases are pure CPU and memory copies and vary little between runs,
+// the LVGL draws depend on the cache state of the fonts and images.
+static const MicroBaseline MICRO_BASELINE[] = {
+    {"bitmap_15x15",            0, 10},
+    {"bitmap_17x17",            0, 10},
+    {"bitmap_320x1",            0, 10},
+    {"bitmap_1x48",             0, 10},
+    {"bitmap_320x48",           0, 10},
+    {"rect_tetris_cell",        0, 15},
+    {"rect_snake_cell",         0, 15},
+    {"rect_snake_cell_border",  0, 15},
+    {"label_score",             0, 15},
+    {"image_bird",              0, 15},
+    {"image_tower_base",        0, 15},
+    {"image_tower_block",       0, 15},
+};
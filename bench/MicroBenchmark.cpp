@@ -0,0 +1,205 @@
+#include "MicroBenchmark.hpp"
+#include "MicroBaseline.hpp"
+#include "app_config.h"
+#include "display_driver.h"
+#include "bird.h"
+#include "base.h"
+#include "red_centre.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include <cstdio>
+#include <cstring>
+
+static const char *TAG = "MicroBenchmark";
+
+static const uint32_t DRIVER_ITERATIONS = 2000;
+static const uint32_t DRAW_LAYERS = 20;
+static const uint32_t DRAWS_PER_LAYER = 10;
+static const int CANVAS_SIZE = 96;
+
+// Largest area LVGL hands to flush_cb is one partial buffer
+static uint16_t s_pixels[FB_SIZE];
+
+LV_DRAW_BUF_DEFINE_STATIC(s_canvasBuf, CANVAS_SIZE, CANVAS_SIZE, LV_COLOR_FORMAT_RGB565);
+
+struct DriverCase {
+    const char* name;
+    int width;
+    int height;
+};
+
+// Tetris and Snake cells, a single text line, a column and a full partial buffer
+static const DriverCase DRIVER_CASES[] = {
+    {"bitmap_15x15", 15, 15},
+    {"bitmap_17x17", 17, 17},
+    {"bitmap_320x1", DISP_WIDTH, 1},
+    {"bitmap_1x48", 1, 48},
+    {"bitmap_320x48", DISP_WIDTH, FB_SIZE / DISP_WIDTH},
+};
+
+MicroBenchmark& MicroBenchmark::instance() {
+    static MicroBenchmark inst;
+    return inst;
+}
+
+esp_err_t MicroBenchmark::mockTxParam(esp_lcd_panel_io_t* io, int lcdCmd, const void* param, size_t paramSize) {
+    return ESP_OK;
+}
+
+esp_err_t MicroBenchmark::mockTxColor(esp_lcd_panel_io_t* io, int lcdCmd, const void* color, size_t colorSize) {
+    return ESP_OK;
+}
+
+void MicroBenchmark::run() {
+    ESP_LOGW(TAG, "Running microbenchmarks");
+
+    results_.clear();
+    benchDriver();
+    benchDraw();
+    printJson();
+}
+
+void MicroBenchmark::record(const char* name, int64_t totalUs, uint32_t iterations) {
+    Result result = {name, static_cast<uint32_t>(totalUs * 1000 / iterations), 0, 0, false};
+
+    for (const auto& base : MICRO_BASELINE) {
+        if (strcmp(base.name, name) == 0) {
+            result.baselineNs = base.ns;
+            result.thresholdPct = base.thresholdPct;
+            result.regression = base.ns && result.ns > base.ns * (100 + base.thresholdPct) / 100;
+            break;
+        }
+    }
+
+    if (result.regression) {
+        ESP_LOGW(TAG, "REGRESSION %s: %lu ns, baseline %lu ns +%lu%%", name, result.ns, result.baselineNs,
+                 result.thresholdPct);
+    }
+    results_.push_back(result);
+}
+
+void MicroBenchmark::benchDriver() {
+    // Panel is never deleted, panel_ili9481_del would release the real reset GPIO
+    if (!mockPanel_) {
+        mockIo_.tx_param = mockTxParam;
+        mockIo_.tx_color = mockTxColor;
+
+        esp_lcd_panel_dev_config_t config = {};
+        config.reset_gpio_num = -1;
+        config.bits_per_pixel = BITS_PER_PIXEL;
+        if (esp_lcd_new_panel_ili9481(&mockIo_, &config, &mockPanel_) != ESP_OK) {
+            ESP_LOGE(TAG, "Failed to create the mock panel");
+            return;
+        }
+    }
+
+    for (const auto& c : DRIVER_CASES) {
+        int64_t start = esp_timer_get_time();
+        for (uint32_t i = 0; i < DRIVER_ITERATIONS; i++) {
+            esp_lcd_panel_draw_bitmap(mockPanel_, 0, 0, c.width, c.height, s_pixels);
+        }
+        record(c.name, esp_timer_get_time() - start, DRIVER_ITERATIONS);
+    }
+}
+
+template <typename DrawFn>
+static int64_t timeLayers(lv_obj_t* canvas, DrawFn draw) {
+    int64_t start = esp_timer_get_time();
+    for (uint32_t i = 0; i < DRAW_LAYERS; i++) {
+        lv_layer_t layer;
+        lv_canvas_init_layer(canvas, &layer);
+        for (uint32_t j = 0; j < DRAWS_PER_LAYER; j++) {
+            draw(&layer, static_cast<int32_t>(j));
+        }
+        lv_canvas_finish_layer(canvas, &layer);
+    }
+    return esp_timer_get_time() - start;
+}
+
+void MicroBenchmark::benchDraw() {
+    const uint32_t iterations = DRAW_LAYERS * DRAWS_PER_LAYER;
+
+    if (!canvas_) {
+        LV_DRAW_BUF_INIT_STATIC(s_canvasBuf);
+        canvas_ = lv_canvas_create(nullptr);
+        lv_canvas_set_draw_buf(canvas_, &s_canvasBuf);
+    }
+    lv_canvas_fill_bg(canvas_, lv_color_make(0, 0, 0), LV_OPA_COVER);
+
+    // Tetris cell: 15 px, LV_RADIUS_CIRCLE
+    lv_draw_rect_dsc_t rect;
+    lv_draw_rect_dsc_init(&rect);
+    rect.bg_color = lv_color_make(0, 200, 255);
+    rect.radius = LV_RADIUS_CIRCLE;
+    record("rect_tetris_cell", timeLayers(canvas_, [&](lv_layer_t* layer, int32_t i) {
+        lv_area_t area = {i * 4, i * 4, i * 4 + 14, i * 4 + 14};
+        lv_draw_rect(layer, &rect, &area);
+    }), iterations);
+
+    // Snake cell: 17 px, radius 2
+    rect.radius = 2;
+    record("rect_snake_cell", timeLayers(canvas_, [&](lv_layer_t* layer, int32_t i) {
+        lv_area_t area = {i * 4, i * 4, i * 4 + 16, i * 4 + 16};
+        lv_draw_rect(layer, &rect, &area);
+    }), iterations);
+
+    rect.border_width = 1;
+    rect.border_color = lv_color_make(255, 255, 255);
+    record("rect_snake_cell_border", timeLayers(canvas_, [&](lv_layer_t* layer, int32_t i) {
+        lv_area_t area = {i * 4, i * 4, i * 4 + 16, i * 4 + 16};
+        lv_draw_rect(layer, &rect, &area);
+    }), iterations);
+
+    // Score label as Snake renders it
+    lv_draw_label_dsc_t label;
+    lv_draw_label_dsc_init(&label);
+    label.font = &lv_font_montserrat_20;
+    label.color = lv_color_make(255, 255, 255);
+    char text[32];
+    label.text = text;
+    label.text_local = 1;
+    record("label_score", timeLayers(canvas_, [&](lv_layer_t* layer, int32_t i) {
+        snprintf(text, sizeof(text), "Score: %ld", 1230 + i * 10);
+        lv_area_t area = {0, i * 2, CANVAS_SIZE - 1, i * 2 + 24};
+        lv_draw_label(layer, &label, &area);
+    }), iterations);
+
+    struct ImageCase {
+        const char* name;
+        const lv_image_dsc_t* image;
+    };
+    static const ImageCase IMAGE_CASES[] = {
+        {"image_bird", &bird_img},
+        {"image_tower_base", &base_img},
+        {"image_tower_block", &red_centre_img},
+    };
+
+    for (const auto& c : IMAGE_CASES) {
+        lv_draw_image_dsc_t image;
+        lv_draw_image_dsc_init(&image);
+        image.src = c.image;
+        record(c.name, timeLayers(canvas_, [&](lv_layer_t* layer, int32_t i) {
+            lv_area_t area = {i, i, i + static_cast<int32_t>(c.image->header.w) - 1,
+                              i + static_cast<int32_t>(c.image->header.h) - 1};
+            lv_draw_image(layer, &image, &area);
+        }), iterations);
+    }
+}
+
+void MicroBenchmark::printJson() const {
+    printf("MICROBENCH_JSON_BEGIN\n");
+    uint32_t regressions = 0;
+    for (const Result& r : results_) {
+        regressions += r.regression;
+    }
+
+    printf("{\"regressions\":%lu,\"cases\":[\n", regressions);
+    for (size_t i = 0; i < results_.size(); i++) {
+        const Result& r = results_[i];
+        printf("{\"name\":\"%s\",\"ns\":%lu,\"baseline_ns\":%lu,\"threshold_pct\":%lu,\"regression\":%s}%s\n",
+               r.name, r.ns, r.baselineNs, r.thresholdPct, r.regression ? "true" : "false",
+               i + 1 < results_.size() ? "," : "");
+    }
+    printf("]}\n");
+    printf("MICROBENCH_JSON_END\n");
+}
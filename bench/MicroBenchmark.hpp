@@ -0,0 +1,42 @@
+#pragma once
+
+#include "lvgl.h"
+#include "esp_lcd_panel_io_interface.h"
+#include "esp_lcd_panel_ops.h"
+#include <cstdint>
+#include <vector>
+
+// Microbenchmarks of the primitives a frame is made of: the ILI9481 bitmap
+// transfer against a mock panel IO, and LVGL rectangle, label and image draws
+// at the sizes the games use. Results are compared with MicroBaseline.hpp and
+// printed as JSON. Runs as part of the benchmark mode (BENCH_MICRO).
+class MicroBenchmark {
+public:
+    static MicroBenchmark& instance();
+
+    void run();
+
+private:
+    MicroBenchmark() = default;
+
+    struct Result {
+        const char* name;
+        uint32_t ns;
+        uint32_t baselineNs;        // 0 - no reference
+        uint32_t thresholdPct;
+        bool regression;
+    };
+
+    void benchDriver();
+    void benchDraw();
+    void record(const char* name, int64_t totalUs, uint32_t iterations);
+    void printJson() const;
+
+    static esp_err_t mockTxParam(esp_lcd_panel_io_t* io, int lcdCmd, const void* param, size_t paramSize);
+    static esp_err_t mockTxColor(esp_lcd_panel_io_t* io, int lcdCmd, const void* color, size_t colorSize);
+
+    std::vector<Result> results_;
+    esp_lcd_panel_io_t mockIo_ = {};
+    esp_lcd_panel_handle_t mockPanel_ = nullptr;
+    lv_obj_t* canvas_ = nullptr;
+};
@@ -1,4 +1,5 @@
 #pragma once
+#include <cstddef>
 #include <cstdint>
 #include <string>
 
@@ -10,4 +11,24 @@ public:
     virtual void stop() = 0;
     virtual void handleKey(uint32_t key) = 0;
     virtual std::string name() const = 0;
+
+    // Event-driven games only change on input or their own LVGL timers. update() is
+    // then called after every key instead of periodically and the logic loop sleeps.
+    virtual bool isEventDriven() const { return false; }
+
+    // Speculative preloading from the menu, see GamePreloader. preload() runs on another
+    // core before run() and may only stage plain memory (no LVGL objects or timers);
+    // preloadBytes() is what it will allocate, checked against PRELOAD_MAX_BYTES.
+    virtual size_t preloadBytes() const { return 0; }
+    virtual void preload() {}
+
+    // Pipelined games split the frame. simulate() is called by the logic loop instead of
+    // update() without the LVGL lock and may not touch LVGL; the game presents the
+    // published state from its own LVGL timer. update() still runs both for the benchmark.
+    virtual bool isPipelined() const { return false; }
+    virtual void simulate() {}
+
+    // Attract mode, called before run(). Games that can play on their own return true,
+    // any key then leaves the game (handled by ScreenManager).
+    virtual bool setAutoplay(bool /*enabled*/) { return false; }
 };
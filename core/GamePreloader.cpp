@@ -0,0 +1,121 @@
+#include "GamePreloader.hpp"
+#include "app_config.h"
+#include "esp_heap_caps.h"
+#include "esp_log.h"
+
+static const char *TAG = "GamePreloader";
+
+GamePreloader& GamePreloader::instance() {
+    static GamePreloader inst;
+    return inst;
+}
+
+void GamePreloader::start() {
+    if (task_) {
+        return;
+    }
+    discarded_.reserve(2);
+    // Core 0 next to the game logic task, which sleeps while the menu is shown
+    xTaskCreatePinnedToCore(taskEntry, "GamePreloader", 8192, this, PRELOAD_TASK_PRIORITY, &task_, 0);
+}
+
+void GamePreloader::taskEntry(void* arg) {
+    static_cast<GamePreloader*>(arg)->run();
+}
+
+void GamePreloader::request(const GameFactory* factory) {
+    if (!task_) {
+        return;
+    }
+
+    std::unique_ptr<Game> dropped;
+    std::vector<std::unique_ptr<Game>> stale;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        generation_++;
+        requested_ = factory;
+        if (ready_ && readyFactory_ != factory) {
+            dropped = std::move(ready_);
+            readyFactory_ = nullptr;
+        }
+        stale.swap(discarded_);
+        discarded_.reserve(2);
+    }
+    // Destructors of games that never ran may still call stop(), so they run here
+    dropped.reset();
+    stale.clear();
+
+    xTaskNotifyGive(task_);
+}
+
+std::unique_ptr<Game> GamePreloader::take(const GameFactory& factory) {
+    std::unique_ptr<Game> game;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (readyFactory_ == &factory) {
+            game = std::move(ready_);
+            readyFactory_ = nullptr;
+        }
+    }
+    // Anything still in flight is of no use once a game starts
+    request(nullptr);
+
+    ESP_LOGI(TAG, "%s: %s", factory.name.c_str(), game ? "preloaded" : "not ready");
+    return game;
+}
+
+void GamePreloader::run() {
+    for (;;) {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+
+        // Scrolling through the list produces a request per step, wait for it to settle
+        while (ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(PRELOAD_SETTLE_MS)) > 0) {
+        }
+
+        const GameFactory* factory;
+        uint32_t generation;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            factory = requested_;
+            generation = generation_;
+            if (!factory || readyFactory_ == factory) {
+                continue;
+            }
+        }
+
+        preload(factory, generation);
+    }
+}
+
+void GamePreloader::preload(const GameFactory* factory, uint32_t generation) {
+    std::unique_ptr<Game> game = factory->create();
+    if (!game) {
+        return;
+    }
+
+    size_t bytes = game->preloadBytes();
+    size_t dmaFree = heap_caps_get_free_size(MALLOC_CAP_DMA);
+    if (bytes > PRELOAD_MAX_BYTES || dmaFree < bytes + PRELOAD_MIN_FREE_DMA) {
+        // Assets are staged by run() on launch as before
+        ESP_LOGI(TAG, "%s: %zu bytes over the cap (%zu free), constructed only",
+                 factory->name.c_str(), bytes, dmaFree);
+    } else {
+        bool current;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            current = generation == generation_;
+        }
+        if (current) {
+            game->preload();
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (generation == generation_) {
+        ready_ = std::move(game);
+        readyFactory_ = factory;
+        ESP_LOGI(TAG, "%s: ready", factory->name.c_str());
+    } else {
+        discarded_.push_back(std::move(game));
+    }
+}
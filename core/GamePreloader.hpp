@@ -0,0 +1,44 @@
+#pragma once
+#include "GameRegistry.hpp"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include <memory>
+#include <mutex>
+#include <vector>
+
+// Speculative preloading of the game highlighted in the menu. A low priority task
+// on core 0 (idle while the menu is shown) constructs the game and lets it stage
+// its assets with Game::preload(). ScreenManager takes the ready instance on ENTER
+// instead of creating one. A new selection cancels the preload in flight, at most
+// one game is held, and staging is skipped above PRELOAD_MAX_BYTES.
+//
+// No LVGL objects are touched off the LVGL task: screens are still built by run(),
+// and preloaded games are only ever destroyed from request()/take().
+class GamePreloader {
+public:
+    static GamePreloader& instance();
+
+    void start();
+
+    // LVGL task. nullptr cancels and drops the held game.
+    void request(const GameFactory* factory);
+
+    // LVGL task. The preloaded game for this factory, or nullptr when it is not ready.
+    std::unique_ptr<Game> take(const GameFactory& factory);
+
+private:
+    GamePreloader() = default;
+
+    static void taskEntry(void* arg);
+    void run();
+    void preload(const GameFactory* factory, uint32_t generation);
+
+    std::mutex mutex_;
+    TaskHandle_t task_ = nullptr;
+    uint32_t generation_ = 0;
+    const GameFactory* requested_ = nullptr;
+    const GameFactory* readyFactory_ = nullptr;
+    std::unique_ptr<Game> ready_;
+    // Results that arrived after their request was cancelled, destroyed on the LVGL task
+    std::vector<std::unique_ptr<Game>> discarded_;
+};
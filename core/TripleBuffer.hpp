@@ -0,0 +1,42 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+
+// Lock-free state exchange between one producer and one consumer task. The
+// producer always owns a slot to write the next state into and the consumer
+// always owns a complete one to read; publish() and fetch() only swap slot
+// indices, so neither side ever waits for the other.
+template <typename T>
+class TripleBuffer {
+public:
+    // Producer: slot for the next state, keeps its old contents
+    T& back() { return slots_[back_]; }
+
+    // Producer: hand the back slot over as the latest complete state
+    void publish() {
+        uint8_t previous = middle_.exchange(back_ | FRESH, std::memory_order_acq_rel);
+        back_ = previous & INDEX;
+    }
+
+    // Consumer: take the latest published state, false if nothing new arrived
+    bool fetch() {
+        if (!(middle_.load(std::memory_order_relaxed) & FRESH)) {
+            return false;
+        }
+        uint8_t previous = middle_.exchange(front_, std::memory_order_acq_rel);
+        front_ = previous & INDEX;
+        return true;
+    }
+
+    // Consumer: state taken by the last successful fetch()
+    const T& front() const { return slots_[front_]; }
+
+private:
+    static const uint8_t INDEX = 0x03;
+    static const uint8_t FRESH = 0x04;
+
+    T slots_[3] = {};
+    uint8_t back_ = 0;
+    uint8_t front_ = 1;
+    std::atomic<uint8_t> middle_{2};
+};
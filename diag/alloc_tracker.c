@@ -0,0 +1,333 @@
+#include "alloc_tracker.h"
+
+#include <string.h>
+
+#include "esp_attr.h"
+#include "esp_cpu_utils.h"
+#include "esp_debug_helpers.h"
+#include "esp_heap_caps.h"
+#include "esp_log.h"
+#include "freertos/FreeRTOS.h"
+
+static const char *TAG = "alloc_tracker";
+
+typedef struct {
+    uint32_t count;
+    uint32_t bytes;
+} alloc_counter_t;
+
+typedef struct {
+    uint32_t pcs[ALLOC_TRACKER_DEPTH];
+    uint32_t hash;
+    uint32_t count;
+    uint32_t bytes;
+    uint8_t scope;
+    uint8_t source;
+} alloc_site_t;
+
+static const char *SCOPE_NAMES[ALLOC_SCOPE_COUNT] = {"other", "game", "timers", "render"};
+static const char *SOURCE_NAMES[ALLOC_SOURCE_COUNT] = {"heap", "lvgl"};
+
+// Written from both cores and from the allocator hooks
+static portMUX_TYPE s_lock = portMUX_INITIALIZER_UNLOCKED;
+
+static uint32_t s_total_count = 0;
+static uint64_t s_total_bytes = 0;
+
+static bool s_enabled = false;
+static alloc_counter_t s_frame[ALLOC_SCOPE_COUNT][ALLOC_SOURCE_COUNT];
+static alloc_counter_t s_session[ALLOC_SCOPE_COUNT][ALLOC_SOURCE_COUNT];
+static uint32_t s_session_frames = 0;
+static uint32_t s_session_alloc_frames = 0;    // frames with at least one allocation
+static uint32_t s_session_max_allocs = 0;
+static alloc_site_t s_sites[ALLOC_TRACKER_SITES];
+static uint32_t s_sites_dropped = 0;
+static char s_session_label[32] = "boot";
+
+// Scope of the calling task. The guard stops call site capture from recursing into itself.
+static __thread uint8_t s_scope = ALLOC_SCOPE_OTHER;
+static __thread bool s_busy = false;
+// Set while the LVGL allocator runs, its heap_caps calls are already counted as LVGL
+static __thread bool s_in_lvgl = false;
+
+// Render scope is entered from the refresh events of the LVGL task
+static alloc_scope_t s_refr_previous = ALLOC_SCOPE_OTHER;
+
+void *__real_lv_malloc_core(size_t size);
+void *__real_lv_realloc_core(void *p, size_t new_size);
+
+static inline
+uint32_t hash_pcs(const uint32_t *pcs)
+{
+    // FNV-1a over the backtrace
+    uint32_t hash = 2166136261u;
+    for (int i = 0; i < ALLOC_TRACKER_DEPTH; i++) {
+        hash = (hash ^ pcs[i]) * 16777619u;
+    }
+    return hash;
+}
+
+static IRAM_ATTR __attribute__((noinline))
+void capture_backtrace(uint32_t *pcs, int skip)
+{
+    esp_backtrace_frame_t frame;
+    esp_backtrace_get_start(&frame.pc, &frame.sp, &frame.next_pc);
+
+    int level = 0;
+    int n = 0;
+    while (n < ALLOC_TRACKER_DEPTH && esp_backtrace_get_next_frame(&frame)) {
+        if (level++ >= skip) {
+            pcs[n++] = esp_cpu_process_stack_pc(frame.pc);
+        }
+        if (frame.next_pc == 0) {
+            break;
+        }
+    }
+}
+
+// Called with s_lock held
+static IRAM_ATTR
+void record_site(const uint32_t *pcs, size_t size, alloc_scope_t scope, alloc_source_t source)
+{
+    uint32_t hash = hash_pcs(pcs);
+    uint32_t slot = hash % ALLOC_TRACKER_SITES;
+
+    for (int probe = 0; probe < ALLOC_TRACKER_SITES; probe++) {
+        alloc_site_t *site = &s_sites[slot];
+
+        if (site->count == 0) {
+            memcpy(site->pcs, pcs, sizeof(site->pcs));
+            site->hash = hash;
+            site->scope = scope;
+            site->source = source;
+        }
+
+        if (site->hash == hash && site->scope == scope && site->source == source &&
+            memcmp(site->pcs, pcs, sizeof(site->pcs)) == 0) {
+            site->count++;
+            site->bytes += size;
+            return;
+        }
+
+        slot = (slot + 1) % ALLOC_TRACKER_SITES;
+    }
+
+    s_sites_dropped++;
+}
+
+static IRAM_ATTR
+void record(size_t size, alloc_source_t source, int skip)
+{
+    bool in_isr = xPortInIsrContext();
+    uint32_t pcs[ALLOC_TRACKER_DEPTH] = {0};
+    alloc_scope_t scope = ALLOC_SCOPE_OTHER;
+    bool with_site = false;
+
+    if (s_enabled && !in_isr && !s_busy) {
+        s_busy = true;
+        scope = s_scope;
+        capture_backtrace(pcs, skip + 1);
+        with_site = true;
+        s_busy = false;
+    }
+
+    portENTER_CRITICAL_SAFE(&s_lock);
+    if (source == ALLOC_SOURCE_HEAP) {
+        s_total_count++;
+        s_total_bytes += size;
+    }
+    if (s_enabled) {
+        s_frame[scope][source].count++;
+        s_frame[scope][source].bytes += size;
+        if (with_site) {
+            record_site(pcs, size, scope, source);
+        }
+    }
+    portEXIT_CRITICAL_SAFE(&s_lock);
+}
+
+// CONFIG_HEAP_USE_HOOKS, covers malloc/calloc/realloc and operator new
+IRAM_ATTR
+void esp_heap_trace_alloc_hook(void *ptr, size_t size, uint32_t caps)
+{
+    if (ptr && !s_in_lvgl) {
+        record(size, ALLOC_SOURCE_HEAP, 1);
+    }
+}
+
+IRAM_ATTR
+void esp_heap_trace_free_hook(void *ptr)
+{
+}
+
+// -Wl,--wrap, see main/CMakeLists.txt
+void *__wrap_lv_malloc_core(size_t size)
+{
+    s_in_lvgl = true;
+    void *p = __real_lv_malloc_core(size);
+    s_in_lvgl = false;
+    if (p) {
+        record(size, ALLOC_SOURCE_LVGL, 1);
+    }
+    return p;
+}
+
+void *__wrap_lv_realloc_core(void *p, size_t new_size)
+{
+    s_in_lvgl = true;
+    void *np = __real_lv_realloc_core(p, new_size);
+    s_in_lvgl = false;
+    if (np && np != p) {
+        record(new_size, ALLOC_SOURCE_LVGL, 1);
+    }
+    return np;
+}
+
+static
+void close_frame(void)
+{
+    uint32_t frame_allocs = 0;
+
+    portENTER_CRITICAL(&s_lock);
+    for (int scope = 0; scope < ALLOC_SCOPE_COUNT; scope++) {
+        for (int source = 0; source < ALLOC_SOURCE_COUNT; source++) {
+            frame_allocs += s_frame[scope][source].count;
+            s_session[scope][source].count += s_frame[scope][source].count;
+            s_session[scope][source].bytes += s_frame[scope][source].bytes;
+        }
+    }
+    memset(s_frame, 0, sizeof(s_frame));
+    portEXIT_CRITICAL(&s_lock);
+
+    s_session_frames++;
+    if (frame_allocs > 0) {
+        s_session_alloc_frames++;
+    }
+    if (frame_allocs > s_session_max_allocs) {
+        s_session_max_allocs = frame_allocs;
+    }
+}
+
+static
+void display_event_cb(lv_event_t *e)
+{
+    switch (lv_event_get_code(e)) {
+        case LV_EVENT_REFR_START:
+            s_refr_previous = alloc_tracker_enter(ALLOC_SCOPE_RENDER);
+            break;
+        case LV_EVENT_REFR_READY:
+            alloc_tracker_leave(s_refr_previous);
+            if (s_enabled) {
+                close_frame();
+            }
+            break;
+        default:
+            break;
+    }
+}
+
+static
+void print_report(void)
+{
+    uint32_t frames = s_session_frames ? s_session_frames : 1;
+
+    ESP_LOGI(TAG, "[%s] frames=%lu with_allocs=%lu max_allocs/f=%lu",
+             s_session_label, s_session_frames, s_session_alloc_frames, s_session_max_allocs);
+
+    for (int scope = 0; scope < ALLOC_SCOPE_COUNT; scope++) {
+        for (int source = 0; source < ALLOC_SOURCE_COUNT; source++) {
+            const alloc_counter_t *c = &s_session[scope][source];
+            if (c->count == 0) {
+                continue;
+            }
+            uint32_t per_frame_x100 = (uint32_t)((uint64_t)c->count * 100 / frames);
+            ESP_LOGI(TAG, "[%s] %-6s %-4s allocs/f=%lu.%02lu bytes/f=%lu total=%lu",
+                     s_session_label, SCOPE_NAMES[scope], SOURCE_NAMES[source],
+                     per_frame_x100 / 100, per_frame_x100 % 100, c->bytes / frames, c->count);
+        }
+    }
+
+    // Selection of the top call sites, marking printed ones by clearing their count
+    for (int rank = 0; rank < ALLOC_TRACKER_TOP; rank++) {
+        alloc_site_t *top = NULL;
+        for (int i = 0; i < ALLOC_TRACKER_SITES; i++) {
+            if (s_sites[i].count > 0 && (!top || s_sites[i].count > top->count)) {
+                top = &s_sites[i];
+            }
+        }
+        if (!top) {
+            break;
+        }
+
+        char trace[ALLOC_TRACKER_DEPTH * 11 + 1];
+        int len = 0;
+        for (int i = 0; i < ALLOC_TRACKER_DEPTH && top->pcs[i]; i++) {
+            len += snprintf(trace + len, sizeof(trace) - len, " 0x%08lx", top->pcs[i]);
+        }
+        trace[len] = '\0';
+
+        ESP_LOGI(TAG, "[%s] #%d %s/%s count=%lu bytes=%lu:%s", s_session_label, rank + 1,
+                 SCOPE_NAMES[top->scope], SOURCE_NAMES[top->source], top->count, top->bytes, trace);
+        top->count = 0;
+    }
+
+    if (s_sites_dropped > 0) {
+        ESP_LOGW(TAG, "[%s] %lu allocations from untracked call sites (table full)",
+                 s_session_label, s_sites_dropped);
+    }
+}
+
+void alloc_tracker_init(lv_display_t *display)
+{
+    lv_display_add_event_cb(display, display_event_cb, LV_EVENT_REFR_START, NULL);
+    lv_display_add_event_cb(display, display_event_cb, LV_EVENT_REFR_READY, NULL);
+
+    ESP_LOGI(TAG, "Allocation tracker attached");
+}
+
+void alloc_tracker_set_enabled(bool enable)
+{
+    portENTER_CRITICAL(&s_lock);
+    s_enabled = enable;
+    memset(s_frame, 0, sizeof(s_frame));
+    portEXIT_CRITICAL(&s_lock);
+}
+
+alloc_scope_t alloc_tracker_enter(alloc_scope_t scope)
+{
+    alloc_scope_t previous = (alloc_scope_t)s_scope;
+    s_scope = scope;
+    return previous;
+}
+
+void alloc_tracker_leave(alloc_scope_t previous)
+{
+    s_scope = previous;
+}
+
+void alloc_tracker_begin_session(const char *label)
+{
+    if (s_enabled && s_session_frames > 0) {
+        print_report();
+    }
+
+    portENTER_CRITICAL(&s_lock);
+    memset(s_session, 0, sizeof(s_session));
+    memset(s_sites, 0, sizeof(s_sites));
+    s_sites_dropped = 0;
+    portEXIT_CRITICAL(&s_lock);
+
+    s_session_frames = 0;
+    s_session_alloc_frames = 0;
+    s_session_max_allocs = 0;
+    strncpy(s_session_label, label, sizeof(s_session_label) - 1);
+    s_session_label[sizeof(s_session_label) - 1] = '\0';
+}
+
+void alloc_tracker_get_totals(uint32_t *count, uint64_t *bytes)
+{
+    portENTER_CRITICAL(&s_lock);
+    *count = s_total_count;
+    *bytes = s_total_bytes;
+    portEXIT_CRITICAL(&s_lock);
+}
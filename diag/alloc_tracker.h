@@ -0,0 +1,65 @@
+/*
+ *		Allocation tracker
+ *			- Heap allocations through the heap_caps hooks (malloc, new, heap_caps_*)
+ *			- LVGL allocations through --wrap=lv_malloc_core/lv_realloc_core (lvgl_app/mem_policy.c)
+ *			- Per frame counters per subsystem scope
+ *			- Top call sites (raw backtraces, decoded by idf.py monitor)
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "lvgl.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define ALLOC_TRACKER_SITES         64      // distinct call sites kept per session
+#define ALLOC_TRACKER_DEPTH         8       // backtrace frames stored per call site
+#define ALLOC_TRACKER_TOP           8       // call sites printed per report
+
+typedef enum {
+    ALLOC_SCOPE_OTHER = 0,
+    ALLOC_SCOPE_GAME,           // process_game_logic
+    ALLOC_SCOPE_TIMERS,         // lv_timer_handler outside the refresh: input, game timers, animations
+    ALLOC_SCOPE_RENDER,         // display refresh
+    ALLOC_SCOPE_COUNT
+} alloc_scope_t;
+
+typedef enum {
+    ALLOC_SOURCE_HEAP = 0,
+    ALLOC_SOURCE_LVGL,
+    ALLOC_SOURCE_COUNT
+} alloc_source_t;
+
+/***************************************************************************************************
+ * Attach to the display refresh events, frames are closed on LV_EVENT_REFR_READY
+ **************************************************************************************************/
+void alloc_tracker_init(lv_display_t *display);
+
+/***************************************************************************************************
+ * Per frame, per scope and call site accounting. Heap totals are counted regardless.
+ **************************************************************************************************/
+void alloc_tracker_set_enabled(bool enable);
+
+/***************************************************************************************************
+ * Tag allocations of the calling task with a scope, returns the previous one for alloc_tracker_leave
+ **************************************************************************************************/
+alloc_scope_t alloc_tracker_enter(alloc_scope_t scope);
+void alloc_tracker_leave(alloc_scope_t previous);
+
+/***************************************************************************************************
+ * Log the report of the current session (if tracking is enabled) and start a new one
+ **************************************************************************************************/
+void alloc_tracker_begin_session(const char *label);
+
+/***************************************************************************************************
+ * Heap allocations and bytes since boot
+ **************************************************************************************************/
+void alloc_tracker_get_totals(uint32_t *count, uint64_t *bytes);
+
+#ifdef __cplusplus
+}
+#endif
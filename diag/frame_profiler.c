@@ -0,0 +1,269 @@
+#include "frame_profiler.h"
+
+#include <string.h>
+
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "esp_freertos_hooks.h"
+#include "freertos/FreeRTOS.h"
+
+static const char *TAG = "frame_profiler";
+
+// Idle hook gaps longer than this mean another task was running in between.
+#define IDLE_GAP_US     (2 * portTICK_PERIOD_MS * 1000)
+
+static portMUX_TYPE s_lock = portMUX_INITIALIZER_UNLOCKED;
+
+static frame_profile_t s_ring[FRAME_PROFILER_HISTORY];
+static uint32_t s_frames = 0;
+
+// Refresh phase state, only touched from the LVGL task
+static int64_t s_refr_start = 0;
+static int64_t s_flush_start = 0;
+static int64_t s_wait_start = 0;
+static int64_t s_logic_mark = 0;
+static uint32_t s_cur_flush_us = 0;
+static uint32_t s_cur_wait_us = 0;
+static bool s_rendered = false;
+static bool s_in_handler = false;
+
+// Logic time collected for the next frame, written from both cores
+static uint32_t s_pending_game_us = 0;
+static int64_t s_game_start = 0;
+
+// Statistic window
+static int64_t s_window_start = 0;
+static uint32_t s_window_frames = 0;
+static frame_profile_t s_window_sum;
+static frame_profile_t s_window_max;
+static frame_profiler_summary_t s_summary;
+static bool s_uart_report = false;
+
+// Idle accounting, each slot is written only by the idle task of its core
+static int64_t s_idle_last[2];
+static int64_t s_idle_us[2];
+static int64_t s_idle_snapshot[2];
+
+static inline
+void account_idle(int core)
+{
+    int64_t now = esp_timer_get_time();
+    int64_t gap = now - s_idle_last[core];
+    if (gap < IDLE_GAP_US) {
+        s_idle_us[core] += gap;
+    }
+    s_idle_last[core] = now;
+}
+
+static
+bool idle_hook_cpu0(void)
+{
+    account_idle(0);
+    return true;
+}
+
+static
+bool idle_hook_cpu1(void)
+{
+    account_idle(1);
+    return true;
+}
+
+static inline
+void add_pending_game(uint32_t us)
+{
+    portENTER_CRITICAL(&s_lock);
+    s_pending_game_us += us;
+    portEXIT_CRITICAL(&s_lock);
+}
+
+static
+void commit_frame(uint32_t refr_us)
+{
+    frame_profile_t frame;
+
+    portENTER_CRITICAL(&s_lock);
+    frame.game_us = s_pending_game_us;
+    s_pending_game_us = 0;
+    portEXIT_CRITICAL(&s_lock);
+
+    uint32_t io_us = s_cur_flush_us + s_cur_wait_us;
+    frame.render_us = refr_us > io_us ? refr_us - io_us : 0;
+    frame.flush_us = s_cur_flush_us;
+    frame.wait_us = s_cur_wait_us;
+
+    portENTER_CRITICAL(&s_lock);
+    s_ring[s_frames % FRAME_PROFILER_HISTORY] = frame;
+    s_frames++;
+    portEXIT_CRITICAL(&s_lock);
+
+    s_window_frames++;
+    s_window_sum.game_us += frame.game_us;
+    s_window_sum.render_us += frame.render_us;
+    s_window_sum.flush_us += frame.flush_us;
+    s_window_sum.wait_us += frame.wait_us;
+    if (frame.game_us > s_window_max.game_us) s_window_max.game_us = frame.game_us;
+    if (frame.render_us > s_window_max.render_us) s_window_max.render_us = frame.render_us;
+    if (frame.flush_us > s_window_max.flush_us) s_window_max.flush_us = frame.flush_us;
+    if (frame.wait_us > s_window_max.wait_us) s_window_max.wait_us = frame.wait_us;
+}
+
+static
+void display_event_cb(lv_event_t *e)
+{
+    int64_t now = esp_timer_get_time();
+
+    switch (lv_event_get_code(e)) {
+        case LV_EVENT_REFR_START:
+            if (s_in_handler) {
+                add_pending_game((uint32_t)(now - s_logic_mark));
+            }
+            s_refr_start = now;
+            s_cur_flush_us = 0;
+            s_cur_wait_us = 0;
+            s_rendered = false;
+            break;
+        case LV_EVENT_RENDER_START:
+            s_rendered = true;
+            break;
+        case LV_EVENT_FLUSH_START:
+            s_flush_start = now;
+            break;
+        case LV_EVENT_FLUSH_FINISH:
+            s_cur_flush_us += (uint32_t)(now - s_flush_start);
+            break;
+        case LV_EVENT_FLUSH_WAIT_START:
+            s_wait_start = now;
+            break;
+        case LV_EVENT_FLUSH_WAIT_FINISH:
+            s_cur_wait_us += (uint32_t)(now - s_wait_start);
+            break;
+        case LV_EVENT_REFR_READY:
+            if (s_rendered) {
+                commit_frame((uint32_t)(now - s_refr_start));
+            }
+            s_logic_mark = now;
+            break;
+        default:
+            break;
+    }
+}
+
+static
+void close_window(int64_t now)
+{
+    int64_t elapsed = now - s_window_start;
+    frame_profiler_summary_t summary = {0};
+
+    summary.fps_x10 = (uint32_t)((int64_t)s_window_frames * 10000000 / elapsed);
+
+    for (int core = 0; core < 2; core++) {
+        int64_t idle_total = s_idle_us[core];
+        int64_t idle = idle_total - s_idle_snapshot[core];
+        s_idle_snapshot[core] = idle_total;
+
+        int64_t load = 100 - (idle * 100) / elapsed;
+        if (load < 0) load = 0;
+        if (load > 100) load = 100;
+        summary.cpu_load[core] = (uint8_t)load;
+    }
+
+    if (s_window_frames > 0) {
+        summary.avg.game_us = s_window_sum.game_us / s_window_frames;
+        summary.avg.render_us = s_window_sum.render_us / s_window_frames;
+        summary.avg.flush_us = s_window_sum.flush_us / s_window_frames;
+        summary.avg.wait_us = s_window_sum.wait_us / s_window_frames;
+    }
+    summary.max = s_window_max;
+
+    portENTER_CRITICAL(&s_lock);
+    s_summary = summary;
+    portEXIT_CRITICAL(&s_lock);
+
+    if (s_uart_report) {
+        ESP_LOGI(TAG, "fps=%lu.%lu logic=%lu/%lu render=%lu/%lu flush=%lu/%lu wait=%lu/%lu us (avg/max) cpu0=%u%% cpu1=%u%%",
+                 summary.fps_x10 / 10, summary.fps_x10 % 10,
+                 summary.avg.game_us, summary.max.game_us,
+                 summary.avg.render_us, summary.max.render_us,
+                 summary.avg.flush_us, summary.max.flush_us,
+                 summary.avg.wait_us, summary.max.wait_us,
+                 summary.cpu_load[0], summary.cpu_load[1]);
+    }
+
+    s_window_start = now;
+    s_window_frames = 0;
+    memset(&s_window_sum, 0, sizeof(s_window_sum));
+    memset(&s_window_max, 0, sizeof(s_window_max));
+}
+
+void frame_profiler_init(lv_display_t *display)
+{
+    lv_display_add_event_cb(display, display_event_cb, LV_EVENT_ALL, NULL);
+
+    s_window_start = esp_timer_get_time();
+    s_idle_last[0] = s_idle_last[1] = s_window_start;
+
+    if (esp_register_freertos_idle_hook_for_cpu(idle_hook_cpu0, 0) != ESP_OK ||
+        esp_register_freertos_idle_hook_for_cpu(idle_hook_cpu1, 1) != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to register idle hooks, CPU load will read 100%%");
+    }
+
+    ESP_LOGI(TAG, "Frame profiler attached");
+}
+
+void frame_profiler_game_begin(void)
+{
+    s_game_start = esp_timer_get_time();
+}
+
+void frame_profiler_game_end(void)
+{
+    add_pending_game((uint32_t)(esp_timer_get_time() - s_game_start));
+}
+
+void frame_profiler_timers_begin(void)
+{
+    s_logic_mark = esp_timer_get_time();
+    s_in_handler = true;
+}
+
+void frame_profiler_timers_end(void)
+{
+    int64_t now = esp_timer_get_time();
+
+    s_in_handler = false;
+    add_pending_game((uint32_t)(now - s_logic_mark));
+
+    if (now - s_window_start >= (int64_t)FRAME_PROFILER_WINDOW_MS * 1000) {
+        close_window(now);
+    }
+}
+
+uint32_t frame_profiler_read(frame_profile_t *out, uint32_t max, uint32_t *cursor)
+{
+    uint32_t copied = 0;
+
+    portENTER_CRITICAL(&s_lock);
+    if (s_frames - *cursor > FRAME_PROFILER_HISTORY) {
+        *cursor = s_frames - FRAME_PROFILER_HISTORY;
+    }
+    while (*cursor != s_frames && copied < max) {
+        out[copied++] = s_ring[*cursor % FRAME_PROFILER_HISTORY];
+        (*cursor)++;
+    }
+    portEXIT_CRITICAL(&s_lock);
+
+    return copied;
+}
+
+void frame_profiler_get_summary(frame_profiler_summary_t *summary)
+{
+    portENTER_CRITICAL(&s_lock);
+    *summary = s_summary;
+    portEXIT_CRITICAL(&s_lock);
+}
+
+void frame_profiler_set_uart_report(bool enable)
+{
+    s_uart_report = enable;
+}
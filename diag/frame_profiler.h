@@ -0,0 +1,70 @@
+/*
+ *		Frame budget profiler
+ *			- Per-frame phase timings (logic, render, flush submit, flush wait)
+ *			- FPS and per-core load
+ *			- Periodic UART report
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "lvgl.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define FRAME_PROFILER_HISTORY      64
+#define FRAME_PROFILER_WINDOW_MS    1000
+
+typedef struct {
+    uint32_t game_us;       // process_game_logic() + LVGL timers (game ticks, input) outside of refresh
+    uint32_t render_us;     // refresh time minus flush submit and flush wait (layout + SW rendering)
+    uint32_t flush_us;      // time spent inside flush_cb submitting to the i80 bus
+    uint32_t wait_us;       // time LVGL was blocked waiting for a flush to complete
+} frame_profile_t;
+
+typedef struct {
+    uint32_t fps_x10;       // frames per second * 10 over the last window
+    uint8_t cpu_load[2];    // approximate load of core 0 and core 1, in percent
+    frame_profile_t avg;
+    frame_profile_t max;
+} frame_profiler_summary_t;
+
+/***************************************************************************************************
+ * Attach the profiler to the display events and register per-core idle hooks
+ **************************************************************************************************/
+void frame_profiler_init(lv_display_t *display);
+
+/***************************************************************************************************
+ * Bracket the game logic call on the main loop
+ **************************************************************************************************/
+void frame_profiler_game_begin(void);
+void frame_profiler_game_end(void);
+
+/***************************************************************************************************
+ * Bracket lv_timer_handler() in the LVGL task
+ *
+ * Everything inside the handler that is not display refresh is accounted as logic time.
+ * The end call also closes the statistic window once per FRAME_PROFILER_WINDOW_MS.
+ **************************************************************************************************/
+void frame_profiler_timers_begin(void);
+void frame_profiler_timers_end(void);
+
+/***************************************************************************************************
+ * Copy frames committed after *cursor into out (at most max), advance the cursor.
+ * Returns number of frames copied. Frames older than FRAME_PROFILER_HISTORY are skipped.
+ **************************************************************************************************/
+uint32_t frame_profiler_read(frame_profile_t *out, uint32_t max, uint32_t *cursor);
+
+void frame_profiler_get_summary(frame_profiler_summary_t *summary);
+
+/***************************************************************************************************
+ * Print the window summary to UART every FRAME_PROFILER_WINDOW_MS
+ **************************************************************************************************/
+void frame_profiler_set_uart_report(bool enable);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,241 @@
+#include "render_stats.h"
+
+#include <string.h>
+
+#include "app_config.h"
+#include "display_driver.h"
+#include "esp_heap_caps.h"
+#include "esp_log.h"
+
+static const char *TAG = "render_stats";
+
+#define HEAT_COLS       ((DISP_WIDTH + RENDER_STATS_HEAT_TILE - 1) / RENDER_STATS_HEAT_TILE)
+#define HEAT_ROWS       ((DISP_HEIGHT + RENDER_STATS_HEAT_TILE - 1) / RENDER_STATS_HEAT_TILE)
+#define HEAT_PER_FLUSH  96
+#define HEAT_DECAY      16
+
+// Everything below is only touched from the LVGL task (display events and flush_cb)
+static render_stats_t s_frame;
+static render_stats_t s_last_frame;
+static render_stats_t s_session;
+static char s_session_label[32] = "boot";
+static uint64_t s_tx_bytes_mark = 0;
+
+static bool s_diff_mode = false;
+static uint16_t *s_shadow = NULL;
+
+static bool s_heatmap = false;
+static uint8_t s_heat[HEAT_ROWS][HEAT_COLS];
+
+static
+uint32_t area_pixels(const lv_area_t *area)
+{
+    return (uint32_t)lv_area_get_width(area) * (uint32_t)lv_area_get_height(area);
+}
+
+static
+void accumulate(render_stats_t *dst, const render_stats_t *src)
+{
+    dst->frames += src->frames;
+    dst->inv_areas += src->inv_areas;
+    dst->inv_pixels += src->inv_pixels;
+    dst->flush_calls += src->flush_calls;
+    dst->redrawn_pixels += src->redrawn_pixels;
+    dst->changed_pixels += src->changed_pixels;
+    dst->tx_bytes += src->tx_bytes;
+}
+
+static
+void decay_heat(void)
+{
+    for (int y = 0; y < HEAT_ROWS; y++) {
+        for (int x = 0; x < HEAT_COLS; x++) {
+            s_heat[y][x] = s_heat[y][x] > HEAT_DECAY ? s_heat[y][x] - HEAT_DECAY : 0;
+        }
+    }
+}
+
+static
+void end_frame(void)
+{
+    uint64_t tx_total = panel_ili9481_get_tx_bytes();
+
+    s_frame.frames = 1;
+    s_frame.tx_bytes = tx_total - s_tx_bytes_mark;
+    s_tx_bytes_mark = tx_total;
+
+    s_last_frame = s_frame;
+    accumulate(&s_session, &s_frame);
+    memset(&s_frame, 0, sizeof(s_frame));
+
+    if (s_heatmap) {
+        decay_heat();
+    }
+}
+
+static
+void display_event_cb(lv_event_t *e)
+{
+    switch (lv_event_get_code(e)) {
+        case LV_EVENT_INVALIDATE_AREA: {
+            const lv_area_t *area = lv_event_get_param(e);
+            if (area) {
+                s_frame.inv_areas++;
+                s_frame.inv_pixels += area_pixels(area);
+            }
+            break;
+        }
+        case LV_EVENT_REFR_READY:
+            if (s_frame.flush_calls > 0) {
+                end_frame();
+            }
+            break;
+        default:
+            break;
+    }
+}
+
+static
+uint32_t diff_against_shadow(const lv_area_t *area, const uint16_t *pixels)
+{
+    uint32_t changed = 0;
+    int32_t w = lv_area_get_width(area);
+
+    for (int32_t y = area->y1; y <= area->y2; y++) {
+        uint16_t *shadow_row = &s_shadow[y * DISP_WIDTH + area->x1];
+        for (int32_t x = 0; x < w; x++) {
+            if (shadow_row[x] != *pixels) {
+                shadow_row[x] = *pixels;
+                changed++;
+            }
+            pixels++;
+        }
+    }
+
+    return changed;
+}
+
+static inline
+uint16_t blend_565(uint16_t c, uint16_t tint, uint8_t alpha)
+{
+    uint32_t inv = 255 - alpha;
+    uint32_t r = (((c >> 11) & 0x1F) * inv + ((tint >> 11) & 0x1F) * alpha) / 255;
+    uint32_t g = (((c >> 5) & 0x3F) * inv + ((tint >> 5) & 0x3F) * alpha) / 255;
+    uint32_t b = ((c & 0x1F) * inv + (tint & 0x1F) * alpha) / 255;
+    return (uint16_t)((r << 11) | (g << 5) | b);
+}
+
+static
+void apply_heatmap(const lv_area_t *area, uint16_t *pixels)
+{
+    // Panel shows R/B swapped, this reads as red on screen
+    const uint16_t tint = lv_color_to_u16(lv_color_make(0, 0, 255));
+
+    int32_t tx1 = area->x1 / RENDER_STATS_HEAT_TILE;
+    int32_t tx2 = area->x2 / RENDER_STATS_HEAT_TILE;
+    int32_t ty1 = area->y1 / RENDER_STATS_HEAT_TILE;
+    int32_t ty2 = area->y2 / RENDER_STATS_HEAT_TILE;
+
+    for (int32_t ty = ty1; ty <= ty2; ty++) {
+        for (int32_t tx = tx1; tx <= tx2; tx++) {
+            uint32_t heat = s_heat[ty][tx] + HEAT_PER_FLUSH;
+            s_heat[ty][tx] = heat > 255 ? 255 : (uint8_t)heat;
+        }
+    }
+
+    int32_t w = lv_area_get_width(area);
+    for (int32_t y = area->y1; y <= area->y2; y++) {
+        const uint8_t *heat_row = s_heat[y / RENDER_STATS_HEAT_TILE];
+        for (int32_t x = area->x1; x < area->x1 + w; x++) {
+            // Keep at most half of the original color visible
+            uint8_t alpha = heat_row[x / RENDER_STATS_HEAT_TILE] >> 1;
+            *pixels = blend_565(*pixels, tint, alpha);
+            pixels++;
+        }
+    }
+}
+
+void render_stats_init(lv_display_t *display)
+{
+    lv_display_add_event_cb(display, display_event_cb, LV_EVENT_INVALIDATE_AREA, NULL);
+    lv_display_add_event_cb(display, display_event_cb, LV_EVENT_REFR_READY, NULL);
+
+    s_tx_bytes_mark = panel_ili9481_get_tx_bytes();
+
+    ESP_LOGI(TAG, "Render statistics attached");
+}
+
+void render_stats_on_flush(const lv_area_t *area, uint8_t *color_map)
+{
+    uint16_t *pixels = (uint16_t *)color_map;
+    uint32_t pixel_count = area_pixels(area);
+
+    s_frame.flush_calls++;
+    s_frame.redrawn_pixels += pixel_count;
+
+    if (s_diff_mode && s_shadow) {
+        s_frame.changed_pixels += diff_against_shadow(area, pixels);
+    }
+
+    if (s_heatmap) {
+        apply_heatmap(area, pixels);
+    }
+}
+
+void render_stats_begin_session(const char *label)
+{
+    if (s_session.frames > 0) {
+        uint32_t frames = s_session.frames;
+        ESP_LOGI(TAG, "[%s] frames=%lu inv_areas/f=%lu inv_px/f=%lu flush/f=%lu redrawn_px/f=%lu tx_bytes/f=%llu",
+                 s_session_label, frames,
+                 s_session.inv_areas / frames,
+                 s_session.inv_pixels / frames,
+                 s_session.flush_calls / frames,
+                 s_session.redrawn_pixels / frames,
+                 s_session.tx_bytes / frames);
+
+        if (s_diff_mode && s_session.changed_pixels > 0) {
+            ESP_LOGI(TAG, "[%s] changed_px/f=%lu redrawn/changed=%lu.%02lu",
+                     s_session_label,
+                     s_session.changed_pixels / frames,
+                     s_session.redrawn_pixels / s_session.changed_pixels,
+                     (s_session.redrawn_pixels % s_session.changed_pixels) * 100 / s_session.changed_pixels);
+        }
+    }
+
+    memset(&s_session, 0, sizeof(s_session));
+    strncpy(s_session_label, label, sizeof(s_session_label) - 1);
+    s_session_label[sizeof(s_session_label) - 1] = '\0';
+}
+
+void render_stats_get_last_frame(render_stats_t *stats)
+{
+    *stats = s_last_frame;
+}
+
+void render_stats_get_session(render_stats_t *stats)
+{
+    *stats = s_session;
+}
+
+void render_stats_set_diff_mode(bool enable)
+{
+    if (enable && !s_shadow) {
+        s_shadow = heap_caps_calloc(DISP_WIDTH * DISP_HEIGHT, sizeof(uint16_t), MALLOC_CAP_SPIRAM);
+        if (!s_shadow) {
+            ESP_LOGE(TAG, "No PSRAM for the shadow frame, diff mode disabled");
+            return;
+        }
+    } else if (!enable && s_shadow) {
+        heap_caps_free(s_shadow);
+        s_shadow = NULL;
+    }
+
+    s_diff_mode = enable;
+}
+
+void render_stats_set_heatmap(bool enable)
+{
+    s_heatmap = enable;
+    memset(s_heat, 0, sizeof(s_heat));
+}
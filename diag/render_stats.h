@@ -0,0 +1,57 @@
+/*
+ *		Render statistics collector
+ *			- Invalidated areas and pixels per frame
+ *			- Flush calls, redrawn pixels and bytes sent to the panel
+ *			- Redrawn vs. actually changed pixels (diff mode)
+ *			- Heat map tint of recently redrawn regions
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "lvgl.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define RENDER_STATS_HEAT_TILE      16      // heat map granularity in pixels
+
+typedef struct {
+    uint32_t frames;
+    uint32_t inv_areas;         // LV_EVENT_INVALIDATE_AREA count
+    uint32_t inv_pixels;        // pixels of the invalidated areas (before LVGL joins them)
+    uint32_t flush_calls;
+    uint32_t redrawn_pixels;    // pixels handed to flush_cb
+    uint32_t changed_pixels;    // pixels that differ from the previous frame, only in diff mode
+    uint64_t tx_bytes;          // bytes sent by panel_ili9481_draw_bitmap
+} render_stats_t;
+
+/***************************************************************************************************
+ * Attach to the display events. Diff mode keeps a full shadow frame in PSRAM.
+ **************************************************************************************************/
+void render_stats_init(lv_display_t *display);
+
+/***************************************************************************************************
+ * Called from flush_cb before the area is sent to the panel
+ *
+ * Counts the area, compares it against the shadow frame in diff mode and tints it
+ * in heat map mode. color_map may be modified.
+ **************************************************************************************************/
+void render_stats_on_flush(const lv_area_t *area, uint8_t *color_map);
+
+/***************************************************************************************************
+ * Close the current session (logging its totals under the previous label) and start a new one
+ **************************************************************************************************/
+void render_stats_begin_session(const char *label);
+
+void render_stats_get_last_frame(render_stats_t *stats);
+void render_stats_get_session(render_stats_t *stats);
+
+void render_stats_set_diff_mode(bool enable);
+void render_stats_set_heatmap(bool enable);
+
+#ifdef __cplusplus
+}
+#endif
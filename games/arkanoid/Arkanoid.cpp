@@ -2,6 +2,8 @@
 #include "Arkanoid.hpp"
 #include "GameRegistry.hpp"
 #include "lvgl_helper.hpp"
+#include "DeferredDeleter.hpp"
+#include "OverlayService.hpp"
 #include <cstdio>
 #include <cmath>
 #include "esp_log.h"
@@ -19,16 +21,17 @@ Arkanoid::Arkanoid()
     : screen_(nullptr),
       scoreLabel_(nullptr),
       livesLabel_(nullptr),
-      updateTimer_(nullptr),
+      presentTimer_(nullptr),
       score_(0),
       lives_(3),
       level_(1),
-      gameRunning_(false),
       ballLaunched_(false),
-      enterPressed_(false),
       escPressed_(false),
+      gameRunning_(false),
+      enterPressed_(false),
       gen_(rd_())
 {
+    bricks_.reserve(MAX_BRICKS);
 }
 
 Arkanoid::~Arkanoid() {
@@ -39,35 +42,58 @@ void Arkanoid::run() {
     ESP_LOGI(TAG, "Starting Arkanoid game");
     createGameScreen();
     resetGame();
+    present();
     gameRunning_ = true;
-    
-    updateTimer_ = lv_timer_create(gameUpdateTimerCallback, 33, this);
+
+    presentTimer_ = lv_timer_create(presentTimerCallback, PRESENT_PERIOD_MS, this);
 }
 
+// Both halves on the calling task, for single-threaded callers such as the benchmark
 void Arkanoid::update() {
+    simulate();
+    present();
+}
+
+void Arkanoid::simulate() {
     if (!gameRunning_) return;
-    
-    uint32_t currentTime = lv_tick_get();
-    
-    if (leftPressed_ && (currentTime - lastKeyTime_ > keyTimeout_)) {
-        leftPressed_ = false;
+
+    for (int i = 0; i < STEPS_PER_TICK && !over_; i++) {
+        step();
+    }
+    publishFrame();
+
+    if (over_) {
+        gameRunning_ = false;
     }
-    if (rightPressed_ && (currentTime - lastKeyTime_ > keyTimeout_)) {
-        rightPressed_ = false;
+}
+
+void Arkanoid::step() {
+    uint32_t currentTime = lv_tick_get();
+
+    // Held direction expires when no repeat arrives, unless a new key replaced it meanwhile
+    int steer = steer_.load();
+    if (steer != 0 && (currentTime - lastKeyTime_.load() > keyTimeout_)) {
+        steer_.compare_exchange_strong(steer, 0);
+        steer = 0;
     }
-    
-    if (leftPressed_) {
-        movePaddle(-paddleMoveSpeed_);
+
+    if (steer != 0) {
+        movePaddle(static_cast<int>(steer * paddleMoveSpeed_));
     }
-    if (rightPressed_) {
-        movePaddle(paddleMoveSpeed_);
+
+    if (launchRequested_.exchange(false) && !ballLaunched_) {
+        ballLaunched_ = true;
+        ball_.vx = ballSpeed_;
+        ball_.vy = -ballSpeed_;
+        ESP_LOGI(TAG, "Ball launched!");
     }
-    
+
     if (!ballLaunched_) return;
-    
+
     updateBall();
+    if (over_) return;
     checkBallCollisions();
-    
+
     bool allDestroyed = true;
     for (const auto& brick : bricks_) {
         if (!brick.destroyed) {
@@ -75,7 +101,7 @@ void Arkanoid::update() {
             break;
         }
     }
-    
+
     if (allDestroyed) {
         level_++;
         ballLaunched_ = false;
@@ -89,58 +115,47 @@ void Arkanoid::stop() {
 
     ESP_LOGI(TAG, "Arkanoid::stop() called");
     gameRunning_ = false;
-    
-    if (updateTimer_) {
-        lv_timer_del(updateTimer_);
-        updateTimer_ = nullptr;
-    }
-    
-    for (auto& brick : bricks_) {
-        if (brick.obj) {
-            lv_obj_del(brick.obj);
-        }
+
+    if (presentTimer_) {
+        lv_timer_del(presentTimer_);
+        presentTimer_ = nullptr;
     }
-    bricks_.clear();
-    
+
+    // Bricks, paddle and ball go with the screen
     if (screen_) {
-        lv_obj_del(screen_);
+        DeferredDeleter::instance().enqueue(screen_);
         screen_ = nullptr;
     }
 }
 
 void Arkanoid::handleKey(uint32_t key) {
     if (!gameRunning_) return;
-    
+
     if (key == LV_KEY_LEFT || key == LV_KEY_RIGHT) {
         lastKeyTime_ = lv_tick_get();
     }
-    
+
     switch (key) {
         case LV_KEY_LEFT:
-            leftPressed_ = true;
-            rightPressed_ = false;
+            steer_ = -1;
             break;
-            
+
         case LV_KEY_RIGHT:
-            rightPressed_ = true;
-            leftPressed_ = false;
+            steer_ = 1;
             break;
-            
+
         case LV_KEY_ENTER:
         case LV_KEY_UP:
-            if (!ballLaunched_ && !enterPressed_) {
-                ballLaunched_ = true;
-                ball_.vx = ballSpeed_;
-                ball_.vy = -ballSpeed_;
+            if (!enterPressed_) {
+                launchRequested_ = true;
                 enterPressed_ = true;
-                ESP_LOGI(TAG, "Ball launched!");
             }
             break;
-            
+
         case LV_KEY_DOWN:
             enterPressed_ = false;
             break;
-            
+
         case LV_KEY_ESC:
         case LV_KEY_BACKSPACE:
             if (!escPressed_) {
@@ -148,7 +163,7 @@ void Arkanoid::handleKey(uint32_t key) {
                 stop();
             }
             break;
-            
+
         default:
             enterPressed_ = false;
             escPressed_ = false;
@@ -159,83 +174,80 @@ void Arkanoid::handleKey(uint32_t key) {
 void Arkanoid::createGameScreen() {
     screen_ = createCleanObject(nullptr);
     lv_obj_set_style_bg_color(screen_, lv_color_make(0, 0, 0), 0);
-    
+
     //LV_IMAGE_DECLARE(background);
-    
+
     //backgroundImg_ = lv_image_create(screen_);
     //lv_image_set_src(backgroundImg_, &background);
     //lv_obj_set_pos(backgroundImg_, 0, 0);
-    
+
     scoreLabel_ = lv_label_create(screen_);
     applyCleanStyle(scoreLabel_);
     lv_obj_set_pos(scoreLabel_, 10, 10);
     lv_obj_set_style_text_color(scoreLabel_, lv_color_make(255, 255, 255), 0);
     lv_obj_set_style_text_font(scoreLabel_, &lv_font_montserrat_20, 0);
-    
+
     livesLabel_ = lv_label_create(screen_);
     applyCleanStyle(livesLabel_);
     lv_obj_set_pos(livesLabel_, 200, 10);
     lv_obj_set_style_text_color(livesLabel_, lv_color_make(255, 255, 255), 0);
     lv_obj_set_style_text_font(livesLabel_, &lv_font_montserrat_20, 0);
-    
+
     lv_obj_t* instructionsLabel = lv_label_create(screen_);
     applyCleanStyle(instructionsLabel);
     lv_label_set_text(instructionsLabel, "<- -> Move paddle\n^/ENTER Launch ball");
     lv_obj_align(instructionsLabel, LV_ALIGN_BOTTOM_MID, 0, -5);
     lv_obj_set_style_text_color(instructionsLabel, lv_color_make(200, 200, 200), 0);
     lv_obj_set_style_text_align(instructionsLabel, LV_TEXT_ALIGN_CENTER, 0);
-    
+
     paddle_.width = 80;
     paddle_.height = 10;
     paddle_.x = 160 - paddle_.width / 2;
     paddle_.y = 440;
-    
-    paddle_.obj = createCleanObject(screen_);
-    lv_obj_set_size(paddle_.obj, paddle_.width, paddle_.height);
-    lv_obj_set_pos(paddle_.obj, paddle_.x, paddle_.y);
-    lv_obj_set_style_bg_color(paddle_.obj, lv_color_make(255, 255, 255), 0);
-    lv_obj_set_style_radius(paddle_.obj, 3, 0);
-    
+
+    paddleObj_ = createCleanObject(screen_);
+    lv_obj_set_size(paddleObj_, paddle_.width, paddle_.height);
+    lv_obj_set_pos(paddleObj_, paddle_.x, paddle_.y);
+    lv_obj_set_style_bg_color(paddleObj_, lv_color_make(255, 255, 255), 0);
+    lv_obj_set_style_radius(paddleObj_, 3, 0);
+
     ball_.size = 8;
-    ball_.obj = createCleanObject(screen_);
-    lv_obj_set_size(ball_.obj, ball_.size, ball_.size);
-    lv_obj_set_style_bg_color(ball_.obj, lv_color_make(255, 255, 255), 0);
-    lv_obj_set_style_radius(ball_.obj, ball_.size / 2, 0);
-    
+    ballObj_ = createCleanObject(screen_);
+    lv_obj_set_size(ballObj_, ball_.size, ball_.size);
+    lv_obj_set_style_bg_color(ballObj_, lv_color_make(255, 255, 255), 0);
+    lv_obj_set_style_radius(ballObj_, ball_.size / 2, 0);
+
     lv_scr_load(screen_);
 }
 
+// Called before the simulation starts, the first frame is presented by run()
 void Arkanoid::resetGame() {
     score_ = 0;
     lives_ = 3;
     level_ = 1;
     ballLaunched_ = false;
+    over_ = false;
     enterPressed_ = false;
     escPressed_ = false;
-    leftPressed_ = false;
-    rightPressed_ = false;
-    
-    updateScore();
+    launchRequested_ = false;
+    steer_ = 0;
+
     createLevel();
-    
+
     paddle_.x = 160 - paddle_.width / 2;
-    lv_obj_set_x(paddle_.obj, paddle_.x);
-    
+
     ball_.x = paddle_.x + paddle_.width / 2.0f - ball_.size / 2.0f;
     ball_.y = paddle_.y - ball_.size - 2.0f;
     ball_.vx = 0;
     ball_.vy = 0;
-    lv_obj_set_pos(ball_.obj, static_cast<int>(ball_.x), static_cast<int>(ball_.y));
+
+    publishFrame();
 }
 
 void Arkanoid::createLevel() {
-    for (auto& brick : bricks_) {
-        if (brick.obj) {
-            lv_obj_del(brick.obj);
-        }
-    }
     bricks_.clear();
-    
+    layout_++;
+
     const int rows = (5 + level_ > 8) ? 8 : 5 + level_;
     const int cols = 8;
     const int brickWidth = 35;
@@ -243,7 +255,7 @@ void Arkanoid::createLevel() {
     const int spacing = 2;
     const int startX = (320 - (cols * (brickWidth + spacing))) / 2;
     const int startY = 50;
-    
+
     for (int row = 0; row < rows; row++) {
         for (int col = 0; col < cols; col++) {
             Brick brick;
@@ -252,25 +264,15 @@ void Arkanoid::createLevel() {
             brick.width = brickWidth;
             brick.height = brickHeight;
             brick.destroyed = false;
-            
+
             if (row < 2) {
                 brick.hits = 3;
-                brick.color = lv_color_make(255, 0, 0);
             } else if (row < 4) {
                 brick.hits = 2;
-                brick.color = lv_color_make(255, 165, 0);
             } else {
                 brick.hits = 1;
-                brick.color = lv_color_make(0, 255, 0);
             }
-            
-            brick.obj = createCleanObject(screen_);
-            lv_obj_set_size(brick.obj, brick.width, brick.height);
-            lv_obj_set_pos(brick.obj, brick.x, brick.y);
-            lv_obj_set_style_bg_color(brick.obj, brick.color, 0);
-            lv_obj_set_style_border_width(brick.obj, 1, 0);
-            lv_obj_set_style_border_color(brick.obj, lv_color_make(128, 128, 128), 0);
-            
+
             bricks_.push_back(brick);
         }
     }
@@ -278,36 +280,32 @@ void Arkanoid::createLevel() {
 
 void Arkanoid::movePaddle(int dx) {
     paddle_.x += dx;
-    
+
     if (paddle_.x < 0) paddle_.x = 0;
     if (paddle_.x > 320 - paddle_.width) paddle_.x = 320 - paddle_.width;
-    
-    lv_obj_set_x(paddle_.obj, paddle_.x);
-    
+
     if (!ballLaunched_) {
         ball_.x = paddle_.x + paddle_.width / 2.0f - ball_.size / 2.0f;
-        lv_obj_set_x(ball_.obj, static_cast<int>(ball_.x));
     }
 }
 
 void Arkanoid::updateBall() {
     ball_.x += ball_.vx;
     ball_.y += ball_.vy;
-    
+
     if (ball_.x <= 0 || ball_.x >= 320 - ball_.size) {
         ball_.vx = -ball_.vx;
         ball_.x = (ball_.x <= 0) ? 0 : 320 - ball_.size;
     }
-    
+
     if (ball_.y <= 40) {
         ball_.vy = -ball_.vy;
         ball_.y = 40;
     }
-    
+
     if (ball_.y > 480) {
         lives_--;
-        updateScore();
-        
+
         if (lives_ > 0) {
             ballLaunched_ = false;
             enterPressed_ = false;
@@ -316,16 +314,14 @@ void Arkanoid::updateBall() {
             ball_.vx = 0;
             ball_.vy = 0;
         } else {
-            gameOver(false);
+            over_ = true;
         }
     }
-    
-    lv_obj_set_pos(ball_.obj, static_cast<int>(ball_.x), static_cast<int>(ball_.y));
 }
 
 void Arkanoid::checkBallCollisions() {
     checkPaddleCollision(ball_);
-    
+
     for (auto& brick : bricks_) {
         if (!brick.destroyed) {
             checkBrickCollision(ball_, brick);
@@ -338,15 +334,15 @@ void Arkanoid::checkBrickCollision(Ball& ball, Brick& brick) {
         ball.x <= brick.x + brick.width &&
         ball.y + ball.size >= brick.y &&
         ball.y <= brick.y + brick.height) {
-        
+
         float ballCenterX = ball.x + ball.size / 2.0f;
         float ballCenterY = ball.y + ball.size / 2.0f;
         float brickCenterX = brick.x + brick.width / 2.0f;
         float brickCenterY = brick.y + brick.height / 2.0f;
-        
+
         float dx = ballCenterX - brickCenterX;
         float dy = ballCenterY - brickCenterY;
-        
+
         if (fabs(dx) > fabs(dy)) {
             ball.vx = -ball.vx;
             if (dx > 0) {
@@ -362,25 +358,13 @@ void Arkanoid::checkBrickCollision(Ball& ball, Brick& brick) {
                 ball.y = brick.y - ball.size;
             }
         }
-        
+
         brick.hits--;
-        
+
         if (brick.hits <= 0) {
             brick.destroyed = true;
-            lv_obj_del(brick.obj);
-            brick.obj = nullptr;
-            
             score_ += 10 * level_;
-            updateScore();
-        } else {
-            if (brick.hits == 2) {
-                lv_obj_set_style_bg_color(brick.obj, lv_color_make(255, 165, 0), 0);
-            } else if (brick.hits == 1) {
-                lv_obj_set_style_bg_color(brick.obj, lv_color_make(0, 255, 0), 0);
-            }
         }
-        
-        lv_obj_set_pos(ball.obj, static_cast<int>(ball.x), static_cast<int>(ball.y));
     }
 }
 
@@ -389,65 +373,145 @@ void Arkanoid::checkPaddleCollision(Ball& ball) {
         ball.x <= paddle_.x + paddle_.width &&
         ball.y + ball.size >= paddle_.y &&
         ball.y <= paddle_.y + paddle_.height) {
-        
+
         ball.vy = -fabs(ball.vy);
-        
+
         float hitPos = (ball.x + ball.size / 2.0f) - paddle_.x;
         float relativePos = hitPos / paddle_.width;
-        
+
         float angle = (relativePos - 0.5f) * 120.0f * 3.14159f / 180.0f;
         float speed = sqrt(ball.vx * ball.vx + ball.vy * ball.vy);
-        
+
         ball.vx = speed * sin(angle);
         ball.vy = -speed * cos(angle);
     }
 }
 
-void Arkanoid::updateScore() {
+void Arkanoid::publishFrame() {
+    Frame& frame = frames_.back();
+
+    frame.paddleX = paddle_.x;
+    frame.ballX = static_cast<int>(ball_.x);
+    frame.ballY = static_cast<int>(ball_.y);
+    frame.score = score_;
+    frame.lives = lives_;
+    frame.level = level_;
+    frame.layout = layout_;
+    frame.brickCount = static_cast<int>(bricks_.size());
+    for (int i = 0; i < frame.brickCount; i++) {
+        frame.brickX[i] = static_cast<int16_t>(bricks_[i].x);
+        frame.brickY[i] = static_cast<int16_t>(bricks_[i].y);
+        frame.brickHits[i] = bricks_[i].destroyed ? 0 : static_cast<int8_t>(bricks_[i].hits);
+    }
+    frame.over = over_;
+
+    frames_.publish();
+}
+
+// LVGL task: applies what changed between the last shown and the latest published frame
+void Arkanoid::present() {
+    if (!screen_ || !frames_.fetch()) return;
+
+    const Frame& frame = frames_.front();
+
+    if (!shownValid_ || frame.layout != shown_.layout) {
+        rebuildBricks(frame);
+    } else {
+        for (int i = 0; i < frame.brickCount; i++) {
+            if (frame.brickHits[i] == shown_.brickHits[i] || !brickObjs_[i]) {
+                continue;
+            }
+            if (frame.brickHits[i] == 0) {
+                lv_obj_del(brickObjs_[i]);
+                brickObjs_[i] = nullptr;
+            } else {
+                lv_obj_set_style_bg_color(brickObjs_[i], brickColor(frame.brickHits[i]), 0);
+            }
+        }
+    }
+
+    if (!shownValid_ || frame.paddleX != shown_.paddleX) {
+        lv_obj_set_x(paddleObj_, frame.paddleX);
+    }
+    if (!shownValid_ || frame.ballX != shown_.ballX || frame.ballY != shown_.ballY) {
+        lv_obj_set_pos(ballObj_, frame.ballX, frame.ballY);
+    }
+    if (!shownValid_ || frame.score != shown_.score || frame.lives != shown_.lives) {
+        updateScore(frame);
+    }
+    if (frame.over && !(shownValid_ && shown_.over)) {
+        gameOver(frame);
+    }
+
+    shown_ = frame;
+    shownValid_ = true;
+}
+
+void Arkanoid::rebuildBricks(const Frame& frame) {
+    for (auto& obj : brickObjs_) {
+        if (obj) {
+            lv_obj_del(obj);
+            obj = nullptr;
+        }
+    }
+
+    for (int i = 0; i < frame.brickCount; i++) {
+        if (frame.brickHits[i] == 0) continue;
+
+        lv_obj_t* obj = createCleanObject(screen_);
+        lv_obj_set_size(obj, 35, 15);
+        lv_obj_set_pos(obj, frame.brickX[i], frame.brickY[i]);
+        lv_obj_set_style_bg_color(obj, brickColor(frame.brickHits[i]), 0);
+        lv_obj_set_style_border_width(obj, 1, 0);
+        lv_obj_set_style_border_color(obj, lv_color_make(128, 128, 128), 0);
+        brickObjs_[i] = obj;
+    }
+
+    // Paddle and ball stay on top of the new bricks
+    lv_obj_move_foreground(paddleObj_);
+    lv_obj_move_foreground(ballObj_);
+}
+
+lv_color_t Arkanoid::brickColor(int hits) {
+    if (hits >= 3) return lv_color_make(255, 0, 0);
+    if (hits == 2) return lv_color_make(255, 165, 0);
+    return lv_color_make(0, 255, 0);
+}
+
+void Arkanoid::updateScore(const Frame& frame) {
     char scoreText[50];
-    snprintf(scoreText, sizeof(scoreText), "Score: %d", score_);
+    snprintf(scoreText, sizeof(scoreText), "Score: %d", frame.score);
     lv_label_set_text(scoreLabel_, scoreText);
-    
+
     char livesText[50];
-    snprintf(livesText, sizeof(livesText), "Lives: %d", lives_);
+    snprintf(livesText, sizeof(livesText), "Lives: %d", frame.lives);
     lv_label_set_text(livesLabel_, livesText);
 }
 
-void Arkanoid::gameOver(bool win) {
-    gameRunning_ = false;
-    
-    lv_obj_t* overlay = createCleanObject(screen_);
-    lv_obj_set_size(overlay, 320, 480);
-    lv_obj_set_pos(overlay, 0, 0);
-    lv_obj_set_style_bg_color(overlay, lv_color_make(0, 0, 0), 0);
-    lv_obj_set_style_bg_opa(overlay, 128, 0);
-    
+void Arkanoid::gameOver(const Frame& frame) {
+    lv_obj_t* overlay = OverlayService::instance().show(screen_, 128);
+
     lv_obj_t* gameOverLabel = lv_label_create(overlay);
     applyCleanStyle(gameOverLabel);
     lv_obj_set_style_text_font(gameOverLabel, &lv_font_montserrat_24, 0);
     lv_obj_set_style_text_align(gameOverLabel, LV_TEXT_ALIGN_CENTER, 0);
 
-    if (win) {
-        lv_label_set_text(gameOverLabel, "YOU WIN!");
-        lv_obj_set_style_text_color(gameOverLabel, lv_color_make(0, 255, 0), 0);
-    } else {
-        char text[50];
-        snprintf(text, sizeof(text), "GAME OVER!\nScore: %d", score_);
-        lv_label_set_text(gameOverLabel, text);
-        lv_obj_set_style_text_color(gameOverLabel, lv_color_make(255, 0, 0), 0);
-    }
+    char text[50];
+    snprintf(text, sizeof(text), "GAME OVER!\nScore: %d", frame.score);
+    lv_label_set_text(gameOverLabel, text);
+    lv_obj_set_style_text_color(gameOverLabel, lv_color_make(255, 0, 0), 0);
 
     lv_obj_center(gameOverLabel);
-    
-    if (updateTimer_) {
-        lv_timer_del(updateTimer_);
-        updateTimer_ = nullptr;
+
+    if (presentTimer_) {
+        lv_timer_del(presentTimer_);
+        presentTimer_ = nullptr;
     }
 }
 
-void Arkanoid::gameUpdateTimerCallback(lv_timer_t* timer) {
+void Arkanoid::presentTimerCallback(lv_timer_t* timer) {
     Arkanoid* game = static_cast<Arkanoid*>(lv_timer_get_user_data(timer));
     if (game) {
-        game->update();
+        game->present();
     }
 }
@@ -1,11 +1,15 @@
 #pragma once
 
 #include "Game.hpp"
+#include "TripleBuffer.hpp"
 #include "lvgl.h"
+#include <atomic>
 #include <string>
 #include <vector>
 #include <random>
 
+// Pipelined: simulate() runs on the game logic task (core 0) without touching
+// LVGL and publishes a Frame, an LVGL timer on core 1 presents the latest one.
 class Arkanoid : public Game {
 public:
     Arkanoid();
@@ -17,73 +21,107 @@ public:
     void handleKey(uint32_t key) override;
     std::string name() const override { return "Arkanoid"; }
 
+    bool isPipelined() const override { return true; }
+    void simulate() override;
+
 private:
+    static const int MAX_BRICKS = 64;   // 8 rows x 8 columns
+
+    // Simulation state, only touched by simulate() once the game runs
     struct Brick {
-        lv_obj_t* obj;
-        //lv_obj_t* img;
         int x, y;
         int width, height;
         int hits;
         bool destroyed;
-        lv_color_t color;
     };
-    
+
     struct Ball {
-        lv_obj_t* obj;
-        //lv_obj_t* img;
         float x, y;
         float vx, vy;
         int size;
     };
-    
+
     struct Paddle {
-        lv_obj_t* obj;
-        //lv_obj_t* img;
         int x, y;
         int width, height;
     };
-    
+
+    // Everything the LVGL side needs to draw one frame
+    struct Frame {
+        int paddleX;
+        int ballX, ballY;
+        int score, lives, level;
+        uint32_t layout;                // changes whenever the bricks are rebuilt
+        int brickCount;
+        int16_t brickX[MAX_BRICKS];
+        int16_t brickY[MAX_BRICKS];
+        int8_t brickHits[MAX_BRICKS];   // 0 once destroyed
+        bool over;
+    };
+
     void createGameScreen();
     void resetGame();
     void createLevel();
+    void step();
     void movePaddle(int dx);
     void updateBall();
     void checkBallCollisions();
     void checkBrickCollision(Ball& ball, Brick& brick);
     void checkPaddleCollision(Ball& ball);
-    void updateScore();
-    void gameOver(bool win);
-    
-    static void gameUpdateTimerCallback(lv_timer_t* timer);
-    
+    void publishFrame();
+
+    void present();
+    void rebuildBricks(const Frame& frame);
+    void updateScore(const Frame& frame);
+    void gameOver(const Frame& frame);
+    static lv_color_t brickColor(int hits);
+
+    static void presentTimerCallback(lv_timer_t* timer);
+
+    // LVGL side, only touched on the LVGL task
     lv_obj_t* screen_;
     lv_obj_t* scoreLabel_;
     lv_obj_t* livesLabel_;
-    lv_timer_t* updateTimer_;
-    
+    lv_obj_t* paddleObj_ = nullptr;
+    lv_obj_t* ballObj_ = nullptr;
+    lv_obj_t* brickObjs_[MAX_BRICKS] = {nullptr};
+    lv_timer_t* presentTimer_;
+    Frame shown_ = {};
+    bool shownValid_ = false;
+
+    TripleBuffer<Frame> frames_;
+
     Paddle paddle_;
     Ball ball_;
     std::vector<Brick> bricks_;
-    
+
     int score_;
     int lives_;
     int level_;
-    bool gameRunning_;
+    uint32_t layout_ = 0;
     bool ballLaunched_;
-    
+    bool over_ = false;
+
     bool stopped_ = false;
-    bool enterPressed_ = false;
     bool escPressed_ = false;
-    
-    bool leftPressed_ = false;
-    bool rightPressed_ = false;
-    uint32_t lastKeyTime_ = 0;
+
+    // Written by handleKey on the LVGL task, read by simulate()
+    std::atomic<bool> gameRunning_;
+    std::atomic<bool> enterPressed_;
+    std::atomic<bool> launchRequested_{false};
+    std::atomic<int> steer_{0};
+    std::atomic<uint32_t> lastKeyTime_{0};
     const uint32_t keyTimeout_ = 500;
-    
+
     const int paddleSpeed_ = 15;
     const float ballSpeed_ = 3.0f;
     const float paddleMoveSpeed_ = 5.0f;
-    
+
+    // The game used to be ticked by its own LVGL timer and by the logic loop, both at
+    // 33 ms. Two steps per simulate() keep that pace and collision granularity.
+    static const int STEPS_PER_TICK = 2;
+    static const uint32_t PRESENT_PERIOD_MS = 16;
+
     std::random_device rd_;
     std::mt19937 gen_;
 
@@ -92,4 +130,4 @@ private:
 
 struct RegisterArkanoid {
     RegisterArkanoid();
-} inline g_registerArkanoid;
\ No newline at end of file
+} inline g_registerArkanoid;
@@ -2,6 +2,7 @@
 #include "GameRegistry.hpp"
 #include "esp_log.h"
 #include "lvgl_helper.hpp"
+#include "DeferredDeleter.hpp"
 #include "bird.h"
 #include <cstdio>
 #include <cstring>
@@ -24,15 +25,46 @@ FlappyBird::FlappyBird()
     gen_(rd_()),
     gapDist_(100, 300)
 {
+    pipes_.reserve(MAX_PIPES);
 }
 
 
 FlappyBird::~FlappyBird() {
     //stop();
+    releaseBirdImage();
 }
 
-static void* dma_image_buffer = nullptr;
-static lv_image_dsc_t bird_img_ram;
+size_t FlappyBird::preloadBytes() const {
+    return birdBuffer_ ? 0 : bird_img.data_size;
+}
+
+void FlappyBird::preload() {
+    stageBirdImage();
+}
+
+/* TODO: Asset too big. So it was splitted on half by DMA.
+         During investigation was found out that DMA does not work with .rodata,
+         But how does green, blue, yellow, etc., asset works - IDK.
+         Need to refactor it. Allocate on SPIRAM maybe? */
+void FlappyBird::stageBirdImage() {
+    if (birdBuffer_) return;
+
+    size_t img_size = bird_img.data_size;
+    birdBuffer_ = heap_caps_malloc(img_size, MALLOC_CAP_DMA);
+    assert(birdBuffer_);
+    memcpy(birdBuffer_, bird_img.data, img_size);
+
+    birdImage_.header = bird_img.header;
+    birdImage_.data_size = bird_img.data_size;
+    birdImage_.data = (const uint8_t*)birdBuffer_;
+}
+
+void FlappyBird::releaseBirdImage() {
+    if (birdBuffer_) {
+        heap_caps_free(birdBuffer_);
+        birdBuffer_ = nullptr;
+    }
+}
 
 void FlappyBird::run() {
     createGameScreen();
@@ -64,16 +96,18 @@ void FlappyBird::stop() {
     }
     pipes_.clear();
 
-    if (screen_) {
-        lv_obj_del(screen_);
-        screen_ = nullptr;
+    // The image points into birdBuffer_, which is freed below
+    if (bird_) {
+        lv_obj_del(bird_);
+        bird_ = nullptr;
     }
 
-    if (dma_image_buffer) {
-        heap_caps_free(dma_image_buffer);
-        dma_image_buffer = nullptr;
+    if (screen_) {
+        DeferredDeleter::instance().enqueue(screen_);
+        screen_ = nullptr;
     }
 
+    releaseBirdImage();
 }
 
 void FlappyBird::handleKey(uint32_t key) {
@@ -100,22 +134,11 @@ void FlappyBird::createGameScreen() {
     lv_obj_set_style_bg_color(groundLine_, lv_color_make(19, 69, 139), 0);
     lv_obj_set_style_border_width(groundLine_, 0, 0);
 
-
-    /* TODO: Asset too big. So it was splitted on half by DMA.
-             During investigation was found out that DMA does not work with .rodata,
-             But how does green, blue, yellow, etc., asset works - IDK.
-             Need to refactor it. Allocate on SPIRAM maybe? */ 
-    size_t img_size = bird_img.data_size;
-    dma_image_buffer = heap_caps_malloc(img_size, MALLOC_CAP_DMA);
-    assert(dma_image_buffer);
-    memcpy(dma_image_buffer, bird_img.data, img_size);
-
-    bird_img_ram.header = bird_img.header;
-    bird_img_ram.data_size = bird_img.data_size;
-    bird_img_ram.data = (const uint8_t*)dma_image_buffer;
+    // Already staged when the menu preloaded the game
+    stageBirdImage();
 
     bird_ = lv_image_create(screen_);
-    lv_image_set_src(bird_, &bird_img_ram);
+    lv_image_set_src(bird_, &birdImage_);
     lv_obj_set_pos(bird_, 50, birdY_);
 
     lv_obj_set_pos(bird_, 50, birdY_);
@@ -16,6 +16,8 @@ public:
     void stop() override;
     void handleKey(uint32_t key) override;
     std::string name() const override { return "Flappy Bird"; }
+    size_t preloadBytes() const override;
+    void preload() override;
 
 private:
     struct Pipe {
@@ -28,6 +30,8 @@ private:
     };
     
     void createGameScreen();
+    void stageBirdImage();
+    void releaseBirdImage();
     void resetGame();
     void updateBird();
     void updatePipes();
@@ -40,12 +44,16 @@ private:
     static void gameUpdateTimerCallback(lv_timer_t* timer);
     
     lv_obj_t* screen_;
-    lv_obj_t* bird_;
+    lv_obj_t* bird_ = nullptr;
     lv_obj_t* scoreLabel_;
     lv_obj_t* groundLine_;
     lv_timer_t* updateTimer_;
     
     std::vector<Pipe> pipes_;
+
+    // DMA capable copy of bird_img, the panel DMA cannot read it from flash
+    void* birdBuffer_ = nullptr;
+    lv_image_dsc_t birdImage_ = {};
     
     float birdY_;
     float birdVelocity_;
@@ -60,6 +68,9 @@ private:
     const int pipeGap_ = 200;
     const int pipeSpeed_ = 3;
     const int groundY_ = 450;
+
+    // A new pipe spawns every 200 px, so at most 3 are on screen at once
+    static const int MAX_PIPES = 4;
     
     std::random_device rd_;
     std::mt19937 gen_;
@@ -0,0 +1,193 @@
+#include "Board2048.hpp"
+#include "esp_heap_caps.h"
+#include "esp_log.h"
+#include <cmath>
+#include <mutex>
+
+static const char *TAG = "Board2048";
+
+static const int ROWS = 65536;
+
+struct Board2048::Tables {
+    uint16_t left[ROWS];        // row after sliding towards x = 0
+    uint16_t right[ROWS];
+    uint32_t score[ROWS];       // merge score of the left move
+    float heuristic[ROWS];
+};
+
+Board2048::Tables* Board2048::tables_ = nullptr;
+
+// Heuristic weights, tuned for expectimax on the 4x4 board: keep empty tiles and
+// pending merges, keep rows monotonic, and penalise many large tiles spread out
+static const float LOST_PENALTY = 200000.0f;
+static const float EMPTY_WEIGHT = 270.0f;
+static const float MERGES_WEIGHT = 700.0f;
+static const float MONOTONICITY_POWER = 4.0f;
+static const float MONOTONICITY_WEIGHT = 47.0f;
+static const float SUM_POWER = 3.5f;
+static const float SUM_WEIGHT = 11.0f;
+
+static void buildRow(Board2048::Bits row, uint16_t& left, uint32_t& score, float& heuristic) {
+    int line[4];
+    for (int i = 0; i < 4; i++) {
+        line[i] = (row >> (4 * i)) & 0xF;
+    }
+
+    float sum = 0.0f;
+    int empty = 0;
+    int merges = 0;
+    int prev = 0;
+    int counter = 0;
+    for (int i = 0; i < 4; i++) {
+        sum += powf(line[i], SUM_POWER);
+        if (line[i] == 0) {
+            empty++;
+        } else {
+            if (prev == line[i]) {
+                counter++;
+            } else if (counter > 0) {
+                merges += 1 + counter;
+                counter = 0;
+            }
+            prev = line[i];
+        }
+    }
+    if (counter > 0) {
+        merges += 1 + counter;
+    }
+
+    float monoLeft = 0.0f;
+    float monoRight = 0.0f;
+    for (int i = 1; i < 4; i++) {
+        float a = powf(line[i - 1], MONOTONICITY_POWER);
+        float b = powf(line[i], MONOTONICITY_POWER);
+        if (line[i - 1] > line[i]) {
+            monoLeft += a - b;
+        } else {
+            monoRight += b - a;
+        }
+    }
+
+    heuristic = LOST_PENALTY + EMPTY_WEIGHT * empty + MERGES_WEIGHT * merges -
+                MONOTONICITY_WEIGHT * fminf(monoLeft, monoRight) - SUM_WEIGHT * sum;
+
+    // Slide left, a tile merges once per move and 32768 tiles stay as they are
+    score = 0;
+    int out[4] = {};
+    int n = 0;
+    bool merged = false;
+    for (int i = 0; i < 4; i++) {
+        if (line[i] == 0) {
+            continue;
+        }
+        if (n > 0 && !merged && out[n - 1] == line[i] && line[i] != 0xF) {
+            out[n - 1]++;
+            score += 1u << out[n - 1];
+            merged = true;
+        } else {
+            out[n++] = line[i];
+            merged = false;
+        }
+    }
+
+    left = 0;
+    for (int i = 0; i < n; i++) {
+        left |= static_cast<uint16_t>(out[i] << (4 * i));
+    }
+}
+
+bool Board2048::initTables() {
+    static std::once_flag once;
+    std::call_once(once, []() {
+        Tables* tables = static_cast<Tables*>(heap_caps_malloc(sizeof(Tables), MALLOC_CAP_SPIRAM));
+        if (!tables) {
+            ESP_LOGE(TAG, "No PSRAM for the move tables (%u bytes)", (unsigned)sizeof(Tables));
+            return;
+        }
+
+        for (int row = 0; row < ROWS; row++) {
+            buildRow(row, tables->left[row], tables->score[row], tables->heuristic[row]);
+        }
+        // Right is the mirrored left move
+        for (int row = 0; row < ROWS; row++) {
+            uint16_t rev = reverseRow(static_cast<uint16_t>(row));
+            tables->right[row] = reverseRow(tables->left[rev]);
+        }
+
+        tables_ = tables;
+        ESP_LOGI(TAG, "Move tables ready (%u bytes)", (unsigned)sizeof(Tables));
+    });
+    return tables_ != nullptr;
+}
+
+Board2048::Bits Board2048::transpose(Bits board) {
+    Bits a1 = board & 0xF0F00F0FF0F00F0FULL;
+    Bits a2 = board & 0x0000F0F00000F0F0ULL;
+    Bits a3 = board & 0x0F0F00000F0F0000ULL;
+    Bits a = a1 | (a2 << 12) | (a3 >> 12);
+    Bits b1 = a & 0xFF00FF0000FF00FFULL;
+    Bits b2 = a & 0x00FF00FF00000000ULL;
+    Bits b3 = a & 0x00000000FF00FF00ULL;
+    return b1 | (b2 >> 24) | (b3 << 24);
+}
+
+Board2048::Bits Board2048::moveRows(Bits board, const uint16_t* table) {
+    return Bits(table[board & 0xFFFF]) |
+           (Bits(table[(board >> 16) & 0xFFFF]) << 16) |
+           (Bits(table[(board >> 32) & 0xFFFF]) << 32) |
+           (Bits(table[(board >> 48) & 0xFFFF]) << 48);
+}
+
+Board2048::Bits Board2048::move(Bits board, Direction dir) {
+    switch (dir) {
+        case LEFT:  return moveRows(board, tables_->left);
+        case RIGHT: return moveRows(board, tables_->right);
+        case UP:    return transpose(moveRows(transpose(board), tables_->left));
+        case DOWN:  return transpose(moveRows(transpose(board), tables_->right));
+        default:    return board;
+    }
+}
+
+uint32_t Board2048::moveScore(Bits board, Direction dir) {
+    if (dir == UP || dir == DOWN) {
+        board = transpose(board);
+    }
+    bool mirrored = dir == RIGHT || dir == DOWN;
+
+    uint32_t score = 0;
+    for (int y = 0; y < SIZE; y++) {
+        uint16_t row = static_cast<uint16_t>(board >> (16 * y));
+        score += tables_->score[mirrored ? reverseRow(row) : row];
+    }
+    return score;
+}
+
+bool Board2048::canMove(Bits board) {
+    if (emptyMask(board)) {
+        return true;
+    }
+    // A full board only moves by merging, LEFT and UP find every adjacent pair
+    return move(board, LEFT) != board || move(board, UP) != board;
+}
+
+int Board2048::emptyCount(Bits board) {
+    return __builtin_popcountll(emptyMask(board));
+}
+
+int Board2048::maxExponent(Bits board) {
+    int best = 0;
+    for (; board; board >>= 4) {
+        int e = board & 0xF;
+        if (e > best) {
+            best = e;
+        }
+    }
+    return best;
+}
+
+float Board2048::heuristic(Bits board) {
+    const float* h = tables_->heuristic;
+    Bits t = transpose(board);
+    return h[board & 0xFFFF] + h[(board >> 16) & 0xFFFF] + h[(board >> 32) & 0xFFFF] + h[(board >> 48) & 0xFFFF] +
+           h[t & 0xFFFF] + h[(t >> 16) & 0xFFFF] + h[(t >> 32) & 0xFFFF] + h[(t >> 48) & 0xFFFF];
+}
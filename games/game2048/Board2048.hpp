@@ -0,0 +1,65 @@
+#pragma once
+
+#include <cstdint>
+
+// 4x4 board packed into 64 bits, one nibble per tile holding its exponent (0 empty,
+// 1 is 2, 2 is 4 ... 15 is 32768). Tile (x, y) is nibble 4 * y + x, so a row is one
+// 16-bit slice. Every 16-bit row has its left and right move, merge score and
+// heuristic precomputed, a move is four table lookups. Vertical moves transpose
+// the board and use the same row tables.
+class Board2048 {
+public:
+    using Bits = uint64_t;
+
+    static const int SIZE = 4;
+    static const int WIN_EXPONENT = 11;     // 2048
+
+    enum Direction {
+        UP,
+        DOWN,
+        LEFT,
+        RIGHT,
+        DIRECTION_COUNT
+    };
+
+    // Builds the tables in PSRAM once (about 768 KB, kept for the whole run).
+    // Thread-safe, false if they could not be allocated.
+    static bool initTables();
+
+    static int tile(Bits board, int x, int y) { return (board >> (4 * (SIZE * y + x))) & 0xF; }
+    static Bits setTile(Bits board, int x, int y, int exponent) {
+        int shift = 4 * (SIZE * y + x);
+        return (board & ~(Bits(0xF) << shift)) | (Bits(exponent) << shift);
+    }
+
+    // The board itself when nothing moves
+    static Bits move(Bits board, Direction dir);
+    // Sum of the tiles created by merges, as in the displayed score
+    static uint32_t moveScore(Bits board, Direction dir);
+
+    static bool canMove(Bits board);
+    static int emptyCount(Bits board);
+    static int maxExponent(Bits board);
+
+    // Bit 4 * i of the result is set for every empty tile i
+    static Bits emptyMask(Bits board) {
+        board |= (board >> 2) & 0x3333333333333333ULL;
+        board |= board >> 1;
+        return ~board & 0x1111111111111111ULL;
+    }
+
+    static Bits transpose(Bits board);
+
+    // Position value for the search, higher is better, only meaningful as a comparison
+    static float heuristic(Bits board);
+
+private:
+    struct Tables;
+
+    static Bits moveRows(Bits board, const uint16_t* table);
+    static uint16_t reverseRow(uint16_t row) {
+        return static_cast<uint16_t>((row >> 12) | ((row >> 4) & 0x00F0) | ((row << 4) & 0x0F00) | (row << 12));
+    }
+
+    static Tables* tables_;
+};
@@ -0,0 +1,133 @@
+#include "Expectimax2048.hpp"
+#include "app_config.h"
+#include "esp_heap_caps.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+
+static const char *TAG = "Expectimax2048";
+
+static const float PROB_CUTOFF = 0.0001f;
+static const uint32_t DEADLINE_CHECK_MASK = 255;    // clock read every 256 boards
+
+Expectimax2048::Expectimax2048() {
+    size_t entries = size_t(1) << G2048_TT_BITS;
+    table_ = static_cast<Entry*>(heap_caps_calloc(entries, sizeof(Entry), MALLOC_CAP_SPIRAM));
+    if (table_) {
+        tableMask_ = static_cast<uint32_t>(entries - 1);
+    } else {
+        // Searches still work, only slower
+        ESP_LOGW(TAG, "No PSRAM for the transposition table");
+    }
+}
+
+Expectimax2048::~Expectimax2048() {
+    heap_caps_free(table_);
+}
+
+Expectimax2048::Result Expectimax2048::think(Board2048::Bits board, int64_t deadlineUs, int maxDepth,
+                                             const std::atomic<bool>* abort) {
+    Result result = {Board2048::LEFT, false, 0};
+    deadlineUs_ = deadlineUs;
+    abort_ = abort;
+
+    for (int depth = 1; depth <= maxDepth; depth++) {
+        // The first pass always finishes so there is a move to return
+        stopping_ = depth > 1;
+        aborted_ = false;
+
+        Board2048::Direction best;
+        bool valid = searchRoot(board, depth, best);
+        if (aborted_) {
+            break;
+        }
+        if (!valid) {
+            return result;
+        }
+        result = {best, true, depth};
+        if (expired()) {
+            break;
+        }
+    }
+    return result;
+}
+
+bool Expectimax2048::expired() {
+    return (abort_ && abort_->load(std::memory_order_relaxed)) || esp_timer_get_time() >= deadlineUs_;
+}
+
+bool Expectimax2048::searchRoot(Board2048::Bits board, int depth, Board2048::Direction& best) {
+    float bestValue = -1.0f;
+    for (int d = 0; d < Board2048::DIRECTION_COUNT; d++) {
+        Board2048::Direction dir = static_cast<Board2048::Direction>(d);
+        Board2048::Bits next = Board2048::move(board, dir);
+        if (next == board) {
+            continue;
+        }
+        float value = chanceNode(next, depth - 1, 1.0f);
+        if (aborted_) {
+            return false;
+        }
+        if (value > bestValue) {
+            bestValue = value;
+            best = dir;
+        }
+    }
+    return bestValue >= 0.0f;
+}
+
+// A new tile on every empty position, 2 with 0.9 and 4 with 0.1
+float Expectimax2048::chanceNode(Board2048::Bits board, int depth, float prob) {
+    evaluated_++;
+    if (stopping_ && (evaluated_ & DEADLINE_CHECK_MASK) == 0 && expired()) {
+        aborted_ = true;
+    }
+    if (aborted_) {
+        return 0.0f;
+    }
+    if (depth == 0 || prob < PROB_CUTOFF) {
+        return Board2048::heuristic(board);
+    }
+
+    Entry* entry = nullptr;
+    if (table_) {
+        uint64_t h = board * 0x9E3779B97F4A7C15ULL;
+        entry = &table_[(h >> 32) & tableMask_];
+        if (entry->depth >= static_cast<uint32_t>(depth) && entry->board == board) {
+            return entry->value;
+        }
+    }
+
+    Board2048::Bits empty = Board2048::emptyMask(board);
+    int count = __builtin_popcountll(empty);
+    prob /= count;
+
+    float sum = 0.0f;
+    while (empty) {
+        Board2048::Bits two = empty & (~empty + 1);     // lowest empty tile, exponent 1
+        empty ^= two;
+        sum += 0.9f * moveNode(board | two, depth, prob * 0.9f);
+        sum += 0.1f * moveNode(board | (two << 1), depth, prob * 0.1f);
+    }
+    float value = sum / count;
+
+    // Values of an interrupted search are incomplete
+    if (entry && !aborted_) {
+        *entry = {board, value, static_cast<uint32_t>(depth)};
+    }
+    return value;
+}
+
+float Expectimax2048::moveNode(Board2048::Bits board, int depth, float prob) {
+    // A board without moves is lost and worth nothing
+    float best = 0.0f;
+    for (int d = 0; d < Board2048::DIRECTION_COUNT; d++) {
+        Board2048::Bits next = Board2048::move(board, static_cast<Board2048::Direction>(d));
+        if (next != board) {
+            float value = chanceNode(next, depth - 1, prob);
+            if (value > best) {
+                best = value;
+            }
+        }
+    }
+    return best;
+}
@@ -0,0 +1,55 @@
+#pragma once
+
+#include "Board2048.hpp"
+#include <atomic>
+#include <cstdint>
+
+// Move search for the 2048 hint and autoplay. Expectimax over the player's moves
+// and the random 2/4 tile (90/10 on every empty tile), iteratively deepened until
+// a deadline. Chance branches below a cumulative probability of 1/10000 are
+// cut off, and evaluated boards are cached in a direct-mapped transposition
+// table in PSRAM that is kept between searches. Board2048 tables must be ready.
+class Expectimax2048 {
+public:
+    struct Result {
+        Board2048::Direction move;
+        bool valid;     // false when no move changes the board
+        int depth;      // deepest search that completed, in player moves
+    };
+
+    Expectimax2048();
+    ~Expectimax2048();
+
+    Expectimax2048(const Expectimax2048&) = delete;
+    Expectimax2048& operator=(const Expectimax2048&) = delete;
+
+    // Depth 1 always completes, deeper searches only before deadlineUs
+    // (esp_timer_get_time()) and while abort is not set
+    Result think(Board2048::Bits board, int64_t deadlineUs, int maxDepth,
+                 const std::atomic<bool>* abort = nullptr);
+
+    // Boards evaluated since the last reset
+    uint32_t evaluated() const { return evaluated_; }
+    void resetStats() { evaluated_ = 0; }
+
+private:
+    struct Entry {
+        Board2048::Bits board;
+        float value;
+        uint32_t depth;     // 0 - empty slot
+    };
+
+    bool searchRoot(Board2048::Bits board, int depth, Board2048::Direction& best);
+    float chanceNode(Board2048::Bits board, int depth, float prob);
+    float moveNode(Board2048::Bits board, int depth, float prob);
+    bool expired();
+
+    Entry* table_ = nullptr;
+    uint32_t tableMask_ = 0;
+
+    int64_t deadlineUs_ = 0;
+    const std::atomic<bool>* abort_ = nullptr;
+    bool stopping_ = false;
+    bool aborted_ = false;
+    uint32_t evaluated_ = 0;
+};
@@ -1,11 +1,20 @@
 #include "Game2048.hpp"
 #include "GameRegistry.hpp"
+#include "Hint2048.hpp"
 #include "lvgl_helper.hpp"
+#include "DeferredDeleter.hpp"
+#include "OverlayService.hpp"
+#include "app_config.h"
 #include <cstdio>
 #include "esp_log.h"
 
 static const char *TAG = "Game2048";
-#include <cstring>
+
+// Static label texts, indexed by exponent
+static const char* const TILE_TEXT[16] = {
+    "", "2", "4", "8", "16", "32", "64", "128", "256", "512",
+    "1024", "2048", "4096", "8192", "16384", "32768"
+};
 
 Game2048::~Game2048() {
     //stop();
@@ -18,28 +27,44 @@ Register2048::Register2048() {
 }
 
 Game2048::Game2048()
-  : score_(0),
+  : tweens_(CELL_COUNT),
+    score_(0),
     gameRunning_(false),
     won_(false),
     stopped_(false),
     gen_(rd_()),
-    posDist_(0, GRID_SIZE - 1),
     valueDist_(1, 10)
 {
-    std::memset(grid_, 0, sizeof(grid_));
 }
 
 
 void Game2048::run() {
     createGameScreen();
+
+    // Builds the move tables unless a preload already did
+    if (!Hint2048::instance().start()) {
+        ESP_LOGE(TAG, "Move tables unavailable");
+        lv_label_set_text(scoreLabel_, "Out of memory");
+        return;
+    }
+
+    searchTimer_ = lv_timer_create(searchTimerCallback, ATTRACT_STEP_MS, this);
+    lv_timer_pause(searchTimer_);
+    tweens_.setIdleCallback(tweensIdleCallback, this);
+
     resetGame();
     gameRunning_ = true;
+
+    if (autoplay_) {
+        lv_label_set_text(hintLabel_, attract_ ? "DEMO" : "AUTO");
+        requestSearch();
+    }
 }
 
 void Game2048::update() {
     if (!gameRunning_) return;
     
-    if (!canMove()) {
+    if (!Board2048::canMove(board_)) {
         gameOver(false);
     }
 }
@@ -52,10 +77,16 @@ void Game2048::stop() {
     gameRunning_ = false;
     ESP_LOGI(TAG, "2048::stop() called");
 
-    if(screen_ && lv_obj_is_valid(screen_)) {
-        lv_obj_clean(screen_);
+    if (searchTimer_) {
+        lv_timer_del(searchTimer_);
+        searchTimer_ = nullptr;
+    }
+    Hint2048::instance().cancel();
+    tweens_.clear();
 
-        lv_obj_del(screen_);
+    // The whole tree goes to the deleter, it is torn down within its frame budget
+    if(screen_ && lv_obj_is_valid(screen_)) {
+        DeferredDeleter::instance().enqueue(screen_);
         screen_ = nullptr;
     }
 
@@ -69,39 +100,45 @@ void Game2048::handleKey(uint32_t key) {
     
     switch (key) {
         case LV_KEY_UP:
-            moved = move(0, -1);
+            moved = move(Board2048::UP);
             break;
             
         case LV_KEY_DOWN:
-            moved = move(0, 1);
+            moved = move(Board2048::DOWN);
             break;
             
         case LV_KEY_LEFT:
-            moved = move(-1, 0);
+            moved = move(Board2048::LEFT);
             break;
             
         case LV_KEY_RIGHT:
-            moved = move(1, 0);
+            moved = move(Board2048::RIGHT);
             break;
 
+        case LV_KEY_ENTER:
+            if (!autoplay_) {
+                lv_label_set_text(hintLabel_, "...");
+                requestSearch();
+            }
+            break;
+
+        // UP+DOWN chord. gpio_driver.c holds UP and DOWN back until the chord can no
+        // longer form, so the toggle never slides the board and adds a tile first.
+        case LV_KEY_NEXT:
+            autoplay_ = !autoplay_;
+            lv_label_set_text(hintLabel_, autoplay_ ? "AUTO" : "");
+            if (autoplay_) {
+                requestSearch();
+            } else {
+                Hint2048::instance().cancel();
+                searching_ = false;
+                lv_timer_pause(searchTimer_);
+            }
+            break;
     }
     
     if (moved) {
-        addRandomTile();
-        updateDisplay();
-        updateScore();
-        
-        if (!won_) {
-            for (int y = 0; y < GRID_SIZE; y++) {
-                for (int x = 0; x < GRID_SIZE; x++) {
-                    if (grid_[y][x] == 2048) {
-                        won_ = true;
-                        gameOver(true);
-                        return;
-                    }
-                }
-            }
-        }
+        afterMove();
     }
 }
 
@@ -116,6 +153,13 @@ void Game2048::createGameScreen() {
     lv_obj_set_pos(scoreLabel_, 10, 10);
     lv_obj_set_style_text_color(scoreLabel_, lv_color_make(255, 255, 255), 0);
     lv_obj_set_style_text_font(scoreLabel_, &lv_font_montserrat_24, 0);
+
+    hintLabel_ = lv_label_create(screen_);
+    applyCleanStyle(hintLabel_);
+    lv_label_set_text(hintLabel_, "");
+    lv_obj_align(hintLabel_, LV_ALIGN_TOP_RIGHT, -10, 10);
+    lv_obj_set_style_text_color(hintLabel_, lv_color_make(255, 255, 0), 0);
+    lv_obj_set_style_text_font(hintLabel_, &lv_font_montserrat_24, 0);
     
     gameBoard_ = createCleanObject(screen_);
     int boardSize = GRID_SIZE * CELL_SIZE + (GRID_SIZE + 1) * CELL_SPACING;
@@ -140,15 +184,35 @@ void Game2048::createGameScreen() {
             
             tileLabels_[y][x] = lv_label_create(tiles_[y][x]);
             applyCleanStyle(tileLabels_[y][x]);
-            lv_label_set_text(tileLabels_[y][x], "");
+            lv_label_set_text_static(tileLabels_[y][x], TILE_TEXT[0]);
             lv_obj_center(tileLabels_[y][x]);
             lv_obj_set_style_text_font(tileLabels_[y][x], &lv_font_montserrat_24, 0);
+            lv_obj_set_style_text_color(tileLabels_[y][x], lv_color_make(255, 255, 255), 0);
         }
     }
+    for (int i = 0; i < CELL_COUNT; i++) {
+        shown_[i] = 0;
+    }
+
+    // Created after the cells so they slide on top of them
+    for (int i = 0; i < MOVER_COUNT; i++) {
+        movers_[i] = createCleanObject(gameBoard_);
+        lv_obj_set_size(movers_[i], CELL_SIZE, CELL_SIZE);
+        lv_obj_set_style_radius(movers_[i], 4, 0);
+        lv_obj_set_style_border_width(movers_[i], 0, 0);
+        lv_obj_add_flag(movers_[i], LV_OBJ_FLAG_HIDDEN);
+
+        moverLabels_[i] = lv_label_create(movers_[i]);
+        applyCleanStyle(moverLabels_[i]);
+        lv_label_set_text_static(moverLabels_[i], TILE_TEXT[0]);
+        lv_obj_center(moverLabels_[i]);
+        lv_obj_set_style_text_font(moverLabels_[i], &lv_font_montserrat_24, 0);
+        lv_obj_set_style_text_color(moverLabels_[i], lv_color_make(255, 255, 255), 0);
+    }
     
     lv_obj_t* instructionsLabel = lv_label_create(screen_);
     applyCleanStyle(instructionsLabel);
-    lv_label_set_text(instructionsLabel, "Use arrows to move tiles");
+    lv_label_set_text(instructionsLabel, "Arrows move, ENTER hint, UP+DOWN auto");
     lv_obj_align(instructionsLabel, LV_ALIGN_BOTTOM_MID, 0, -10);
     lv_obj_set_style_text_color(instructionsLabel, lv_color_make(200, 200, 200), 0);
     lv_obj_set_style_text_font(instructionsLabel, &lv_font_montserrat_14, 0);
@@ -159,8 +223,7 @@ void Game2048::createGameScreen() {
 void Game2048::resetGame() {
     score_ = 0;
     won_ = false;
-    
-    memset(grid_, 0, sizeof(grid_));
+    board_ = 0;
     
     addRandomTile();
     addRandomTile();
@@ -170,121 +233,175 @@ void Game2048::resetGame() {
 }
 
 void Game2048::addRandomTile() {
-
-    int emptyCells[GRID_SIZE * GRID_SIZE][2];
-    int emptyCount = 0;
-    
-    for (int y = 0; y < GRID_SIZE; y++) {
-        for (int x = 0; x < GRID_SIZE; x++) {
-            if (grid_[y][x] == 0) {
-                emptyCells[emptyCount][0] = x;
-                emptyCells[emptyCount][1] = y;
-                emptyCount++;
-            }
-        }
-    }
+    Board2048::Bits empty = Board2048::emptyMask(board_);
+    int emptyCount = __builtin_popcountll(empty);
     
     if (emptyCount > 0) {
+        // index-th empty tile, 2 with 0.9 and 4 with 0.1
         int index = std::uniform_int_distribution<>(0, emptyCount - 1)(gen_);
-        int x = emptyCells[index][0];
-        int y = emptyCells[index][1];
-        
-        grid_[y][x] = (valueDist_(gen_) > 1) ? 2 : 4;
+        for (int i = 0; i < index; i++) {
+            empty &= empty - 1;
+        }
+        int shift = __builtin_ctzll(empty);
+        board_ |= Board2048::Bits((valueDist_(gen_) > 1) ? 1 : 2) << shift;
     }
 }
 
-bool Game2048::move(int dx, int dy) {
-    bool moved = false;
-    int newGrid[GRID_SIZE][GRID_SIZE];
-    memcpy(newGrid, grid_, sizeof(grid_));
-    
-    int xStart = (dx > 0) ? GRID_SIZE - 1 : 0;
-    int xEnd = (dx > 0) ? -1 : GRID_SIZE;
-    int xStep = (dx > 0) ? -1 : 1;
-    
-    int yStart = (dy > 0) ? GRID_SIZE - 1 : 0;
-    int yEnd = (dy > 0) ? -1 : GRID_SIZE;
-    int yStep = (dy > 0) ? -1 : 1;
-    
-    for (int y = yStart; y != yEnd; y += yStep) {
-        for (int x = xStart; x != xEnd; x += xStep) {
-            if (newGrid[y][x] == 0) continue;
-            
-            int newX = x;
-            int newY = y;
-            
-            while (true) {
-                int nextX = newX + dx;
-                int nextY = newY + dy;
-                
-                if (nextX < 0 || nextX >= GRID_SIZE || 
-                    nextY < 0 || nextY >= GRID_SIZE ||
-                    newGrid[nextY][nextX] != 0) {
-                    break;
-                }
-                
-                newX = nextX;
-                newY = nextY;
-            }
-            
-            int mergeX = newX + dx;
-            int mergeY = newY + dy;
-            
-            if (mergeX >= 0 && mergeX < GRID_SIZE && 
-                mergeY >= 0 && mergeY < GRID_SIZE &&
-                newGrid[mergeY][mergeX] == newGrid[y][x]) {
-                
-                newGrid[mergeY][mergeX] *= 2;
-                newGrid[y][x] = 0;
-                score_ += newGrid[mergeY][mergeX];
-                moved = true;
-            } else if (newX != x || newY != y) {
-                newGrid[newY][newX] = newGrid[y][x];
-                newGrid[y][x] = 0;
-                moved = true;
-            }
-        }
+bool Game2048::move(Board2048::Direction dir) {
+    Board2048::Bits next = Board2048::move(board_, dir);
+    if (next == board_) {
+        return false;
     }
-    
-    memcpy(grid_, newGrid, sizeof(grid_));
-    return moved;
+    score_ += Board2048::moveScore(board_, dir);
+    slideFrom_ = board_;
+    slideDir_ = dir;
+    board_ = next;
+    return true;
 }
 
-bool Game2048::canMove() {
-    for (int y = 0; y < GRID_SIZE; y++) {
-        for (int x = 0; x < GRID_SIZE; x++) {
-            if (grid_[y][x] == 0) return true;
-        }
+void Game2048::afterMove() {
+    Board2048::Bits moved = board_;
+    addRandomTile();
+    animateMove(slideFrom_, moved, slideDir_);
+    updateScore();
+
+    if (!won_ && Board2048::maxExponent(board_) >= Board2048::WIN_EXPONENT) {
+        won_ = true;
+        gameOver(true);
+        return;
     }
-    
-    for (int y = 0; y < GRID_SIZE; y++) {
-        for (int x = 0; x < GRID_SIZE; x++) {
-            int value = grid_[y][x];
-            
-            if (x < GRID_SIZE - 1 && grid_[y][x + 1] == value) return true;
-            if (y < GRID_SIZE - 1 && grid_[y + 1][x] == value) return true;
-        }
+
+    // A hint is only valid for the board it was computed on
+    if (autoplay_) {
+        requestSearch();
+    } else {
+        Hint2048::instance().cancel();
+        searching_ = false;
+        lv_timer_pause(searchTimer_);
+        lv_label_set_text(hintLabel_, "");
     }
-    
-    return false;
 }
 
 void Game2048::updateDisplay() {
-    for (int y = 0; y < GRID_SIZE; y++) {
-        for (int x = 0; x < GRID_SIZE; x++) {
-            if (grid_[y][x] == 0) {
-                lv_label_set_text(tileLabels_[y][x], "");
-                lv_obj_set_style_bg_color(tiles_[y][x], lv_color_make(80, 80, 80), 0);
+    for (int i = 0; i < CELL_COUNT; i++) {
+        paintCell(i, Board2048::tile(board_, i % GRID_SIZE, i / GRID_SIZE));
+    }
+}
+
+// Replays the row slide of Board2048 per line to find where every tile goes,
+// only for display. Moving tiles are taken over by movers, their cells go empty.
+void Game2048::animateMove(Board2048::Bits before, Board2048::Bits moved, Board2048::Direction dir) {
+    finishAnimation();
+
+    bool horizontal = dir == Board2048::LEFT || dir == Board2048::RIGHT;
+    bool forward = dir == Board2048::LEFT || dir == Board2048::UP;
+    mergedCells_ = 0;
+    moversUsed_ = 0;
+
+    for (int line = 0; line < GRID_SIZE; line++) {
+        // Cells of the line in the order they pack, front first
+        int cells[GRID_SIZE];
+        for (int k = 0; k < GRID_SIZE; k++) {
+            int along = forward ? k : GRID_SIZE - 1 - k;
+            cells[k] = horizontal ? line * GRID_SIZE + along : along * GRID_SIZE + line;
+        }
+
+        int packed = 0;
+        int frontExponent = 0;
+        bool frontMerged = false;
+        for (int k = 0; k < GRID_SIZE; k++) {
+            int from = cells[k];
+            int exponent = Board2048::tile(before, from % GRID_SIZE, from / GRID_SIZE);
+            if (exponent == 0) {
+                continue;
+            }
+
+            int to;
+            if (packed > 0 && !frontMerged && exponent == frontExponent && exponent != 0xF) {
+                to = cells[packed - 1];
+                frontMerged = true;
+                mergedCells_ |= 1 << to;
             } else {
-                char text[16];
-                snprintf(text, sizeof(text), "%d", grid_[y][x]);
-                lv_label_set_text(tileLabels_[y][x], text);
-                lv_obj_set_style_bg_color(tiles_[y][x], getTileColor(grid_[y][x]), 0);
-                
-                lv_obj_set_style_text_color(tileLabels_[y][x], lv_color_make(255, 255, 255), 0);
+                to = cells[packed++];
+                frontExponent = exponent;
+                frontMerged = false;
+            }
+
+            if (to != from && moversUsed_ < MOVER_COUNT) {
+                lv_obj_t* mover = movers_[moversUsed_];
+                paintTile(mover, moverLabels_[moversUsed_], exponent);
+                lv_obj_clear_flag(mover, LV_OBJ_FLAG_HIDDEN);
+                tweens_.start(mover, cellArea(from), cellArea(to), G2048_SLIDE_MS, TweenPool::EASE_OUT);
+                moversUsed_++;
+                paintCell(from, 0);
             }
         }
     }
+
+    Board2048::Bits spawned = board_ ^ moved;
+    spawnedCell_ = spawned ? __builtin_ctzll(spawned) / 4 : -1;
+    sliding_ = true;
+    if (!tweens_.active()) {
+        finishSlide(true);
+    }
+}
+
+// Movers are hidden, the cells show the new board, merges pop and the new tile grows
+void Game2048::finishSlide(bool pop) {
+    sliding_ = false;
+    for (int i = 0; i < moversUsed_; i++) {
+        lv_obj_add_flag(movers_[i], LV_OBJ_FLAG_HIDDEN);
+    }
+    moversUsed_ = 0;
+
+    updateDisplay();
+
+    if (!pop) {
+        return;
+    }
+    for (int i = 0; i < CELL_COUNT; i++) {
+        if (mergedCells_ & (1 << i)) {
+            lv_area_t area = cellArea(i);
+            lv_area_t grown = {area.x1 - POP_GROW, area.y1 - POP_GROW, area.x2 + POP_GROW, area.y2 + POP_GROW};
+            tweens_.start(tiles_[i / GRID_SIZE][i % GRID_SIZE], area, grown, G2048_POP_MS, TweenPool::BUMP);
+        }
+    }
+    if (spawnedCell_ >= 0) {
+        lv_area_t area = cellArea(spawnedCell_);
+        int cx = (area.x1 + area.x2) / 2;
+        int cy = (area.y1 + area.y2) / 2;
+        lv_area_t seed = {cx - CELL_SIZE / 6, cy - CELL_SIZE / 6, cx + CELL_SIZE / 6, cy + CELL_SIZE / 6};
+        tweens_.start(tiles_[spawnedCell_ / GRID_SIZE][spawnedCell_ % GRID_SIZE], seed, area,
+                      G2048_POP_MS, TweenPool::EASE_OUT);
+    }
+}
+
+// Jumps to the end of whatever runs, a new move or an overlay starts from a still board
+void Game2048::finishAnimation() {
+    tweens_.finishAll();
+    if (sliding_) {
+        finishSlide(false);
+    }
+}
+
+void Game2048::paintCell(int cell, int exponent) {
+    if (shown_[cell] == exponent) {
+        return;
+    }
+    shown_[cell] = static_cast<int8_t>(exponent);
+    paintTile(tiles_[cell / GRID_SIZE][cell % GRID_SIZE], tileLabels_[cell / GRID_SIZE][cell % GRID_SIZE], exponent);
+}
+
+void Game2048::paintTile(lv_obj_t* tile, lv_obj_t* label, int exponent) {
+    lv_color_t color = exponent ? getTileColor(1 << exponent) : lv_color_make(80, 80, 80);
+    lv_obj_set_style_bg_color(tile, color, 0);
+    lv_label_set_text_static(label, TILE_TEXT[exponent]);
+}
+
+lv_area_t Game2048::cellArea(int cell) const {
+    int x = CELL_SPACING + (cell % GRID_SIZE) * (CELL_SIZE + CELL_SPACING);
+    int y = CELL_SPACING + (cell / GRID_SIZE) * (CELL_SIZE + CELL_SPACING);
+    return {x, y, x + CELL_SIZE - 1, y + CELL_SIZE - 1};
 }
 
 void Game2048::updateScore() {
@@ -295,12 +412,19 @@ void Game2048::updateScore() {
 
 void Game2048::gameOver(bool win) {
     gameRunning_ = false;
+    // The overlay captures the scene, it has to be the final board
+    finishAnimation();
+    Hint2048::instance().cancel();
+    searching_ = false;
+    gameOverTicks_ = 0;
+    // The demo starts over after ATTRACT_RESTART_MS
+    if (attract_) {
+        lv_timer_resume(searchTimer_);
+    } else {
+        lv_timer_pause(searchTimer_);
+    }
     
-    lv_obj_t* overlayBg = createCleanObject(screen_);
-    lv_obj_set_size(overlayBg, 320, 480);
-    lv_obj_set_pos(overlayBg, 0, 0);
-    lv_obj_set_style_bg_color(overlayBg, lv_color_make(0, 0, 0), 0);
-    lv_obj_set_style_bg_opa(overlayBg, 220, 0);
+    lv_obj_t* overlayBg = OverlayService::instance().show(screen_, 220);
     
     lv_obj_t* gameOverLabel = lv_label_create(overlayBg);
     applyCleanStyle(gameOverLabel);
@@ -315,6 +439,70 @@ void Game2048::gameOver(bool win) {
     lv_obj_center(gameOverLabel);
 }
 
+void Game2048::restartGame() {
+    OverlayService::instance().hide();
+    finishAnimation();
+    resetGame();
+    gameRunning_ = true;
+    requestSearch();
+}
+
+void Game2048::requestSearch() {
+    searching_ = true;
+    Hint2048::instance().request(board_);
+    lv_timer_resume(searchTimer_);
+}
+
+void Game2048::showHint(Board2048::Direction dir) {
+    static const char* const ARROWS[Board2048::DIRECTION_COUNT] = {
+        LV_SYMBOL_UP, LV_SYMBOL_DOWN, LV_SYMBOL_LEFT, LV_SYMBOL_RIGHT
+    };
+    lv_label_set_text(hintLabel_, ARROWS[dir]);
+}
+
+// Polls the search, at most one autoplay move per ATTRACT_STEP_MS
+void Game2048::searchStep() {
+    if (!gameRunning_) {
+        if (attract_ && ++gameOverTicks_ * ATTRACT_STEP_MS >= ATTRACT_RESTART_MS) {
+            restartGame();
+        }
+        return;
+    }
+
+    Expectimax2048::Result result;
+    if (!searching_ || !Hint2048::instance().poll(result)) {
+        return;
+    }
+    searching_ = false;
+    lv_timer_pause(searchTimer_);
+
+    if (!result.valid) {
+        return;
+    }
+    if (autoplay_) {
+        if (move(result.move)) {
+            afterMove();
+            update();
+        }
+    } else {
+        showHint(result.move);
+    }
+}
+
+void Game2048::searchTimerCallback(lv_timer_t* timer) {
+    Game2048* game = static_cast<Game2048*>(lv_timer_get_user_data(timer));
+    if (game) {
+        game->searchStep();
+    }
+}
+
+void Game2048::tweensIdleCallback(void* userData) {
+    Game2048* game = static_cast<Game2048*>(userData);
+    if (game->sliding_) {
+        game->finishSlide(true);
+    }
+}
+
 lv_color_t Game2048::getTileColor(int value) {
     switch (value) {
         case 2:    return lv_color_make(255, 0, 0);
@@ -1,10 +1,18 @@
 #pragma once
 
 #include "Game.hpp"
+#include "Board2048.hpp"
+#include "TweenPool.hpp"
 #include "lvgl.h"
 #include <string>
 #include <random>
 
+// The board is a Board2048 bitboard, moves and the game-over test are table
+// lookups. ENTER asks Hint2048 for the best move, UP+DOWN lets it play.
+//
+// The 16 tile objects stay in their cells. A move slides pooled mover tiles from
+// the old to the new cells, then the cells are repainted and merged tiles pop.
+// All tweens run in one TweenPool, and a cell is only restyled when its value changes.
 class Game2048 : public Game {
 public:
     Game2048();
@@ -15,37 +23,78 @@ public:
     void stop() override;
     void handleKey(uint32_t key) override;
     std::string name() const override { return "2048"; }
+    bool isEventDriven() const override { return true; }
+
+    // The move tables are plain PSRAM shared by every instance, built once
+    void preload() override { Board2048::initTables(); }
+
+    bool setAutoplay(bool enabled) override { autoplay_ = enabled; attract_ = enabled; return true; }
 
 private:
-    static const int GRID_SIZE = 4;
+    static const int GRID_SIZE = Board2048::SIZE;
     static const int CELL_SIZE = 65;
     static const int CELL_SPACING = 6;
+    static const int CELL_COUNT = GRID_SIZE * GRID_SIZE;
+    static const int MOVER_COUNT = 12;      // the front tile of a line never slides
+    static const int POP_GROW = 3;          // px per side, neighbours just touch
     
     void createGameScreen();
     void resetGame();
     void addRandomTile();
-    bool move(int dx, int dy);
-    bool canMove();
+    bool move(Board2048::Direction dir);
+    void afterMove();
     void updateDisplay();
+    void animateMove(Board2048::Bits before, Board2048::Bits moved, Board2048::Direction dir);
+    void finishSlide(bool pop);
+    void finishAnimation();
+    void paintCell(int cell, int exponent);
+    void paintTile(lv_obj_t* tile, lv_obj_t* label, int exponent);
+    lv_area_t cellArea(int cell) const;
     void updateScore();
     void gameOver(bool win);
+    void requestSearch();
+    void showHint(Board2048::Direction dir);
+    void searchStep();
+    void restartGame();
     lv_color_t getTileColor(int value);
+
+    static void searchTimerCallback(lv_timer_t* timer);
+    static void tweensIdleCallback(void* userData);
     
     lv_obj_t* screen_;
     lv_obj_t* gameBoard_;
     lv_obj_t* scoreLabel_;
     lv_obj_t* tiles_[GRID_SIZE][GRID_SIZE];
     lv_obj_t* tileLabels_[GRID_SIZE][GRID_SIZE];
-    
-    int grid_[GRID_SIZE][GRID_SIZE];
+    lv_obj_t* movers_[MOVER_COUNT];
+    lv_obj_t* moverLabels_[MOVER_COUNT];
+    lv_obj_t* hintLabel_ = nullptr;    // hint arrow, or AUTO / DEMO while autoplaying
+    lv_timer_t* searchTimer_ = nullptr;
+
+    Board2048::Bits board_ = 0;
+    Board2048::Bits slideFrom_ = 0;     // board before the last move
+    Board2048::Direction slideDir_ = Board2048::LEFT;
+
+    // Animation, cells are indexed like the board nibbles (4 * y + x)
+    TweenPool tweens_;
+    int8_t shown_[CELL_COUNT];          // exponent each cell is painted with, -1 unknown
+    int moversUsed_ = 0;
+    bool sliding_ = false;
+    uint16_t mergedCells_ = 0;          // pop when the slide ends
+    int spawnedCell_ = -1;
     int score_;
     bool gameRunning_;
     bool won_;
     bool stopped_ = false;
+
+    // Hint and autoplay, the search result is polled by searchTimer_
+    bool autoplay_ = false;
+    bool attract_ = false;      // started by ScreenManager, restarts after game over
+    bool searching_ = false;
+    int gameOverTicks_ = 0;
     
     std::random_device rd_;
     std::mt19937 gen_;
-    std::uniform_int_distribution<> posDist_;
     std::uniform_int_distribution<> valueDist_;
 };
 
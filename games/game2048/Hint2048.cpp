@@ -0,0 +1,98 @@
+#include "Hint2048.hpp"
+#include "app_config.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+
+static const char *TAG = "Hint2048";
+
+Hint2048& Hint2048::instance() {
+    static Hint2048 inst;
+    return inst;
+}
+
+bool Hint2048::start() {
+    if (task_) {
+        return true;
+    }
+    if (!Board2048::initTables()) {
+        return false;
+    }
+
+    search_ = std::make_unique<Expectimax2048>();
+    // Core 0 next to the game logic task, which sleeps between keys in 2048
+    if (xTaskCreatePinnedToCore(taskEntry, "Hint2048", 4096, this, G2048_SEARCH_PRIORITY, &task_, 0) != pdPASS) {
+        ESP_LOGE(TAG, "Failed to create the search task");
+        task_ = nullptr;
+        search_.reset();
+        return false;
+    }
+    return true;
+}
+
+void Hint2048::taskEntry(void* arg) {
+    static_cast<Hint2048*>(arg)->run();
+}
+
+void Hint2048::request(Board2048::Bits board) {
+    if (!task_) {
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        generation_++;
+        board_ = board;
+        pending_ = true;
+        ready_ = false;
+        abort_.store(true, std::memory_order_relaxed);
+    }
+    xTaskNotifyGive(task_);
+}
+
+void Hint2048::cancel() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    generation_++;
+    pending_ = false;
+    ready_ = false;
+    abort_.store(true, std::memory_order_relaxed);
+}
+
+bool Hint2048::poll(Expectimax2048::Result& result) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!ready_) {
+        return false;
+    }
+    ready_ = false;
+    result = result_;
+    return true;
+}
+
+void Hint2048::run() {
+    for (;;) {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+
+        Board2048::Bits board;
+        uint32_t generation;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (!pending_) {
+                continue;
+            }
+            pending_ = false;
+            board = board_;
+            generation = generation_;
+            abort_.store(false, std::memory_order_relaxed);
+        }
+
+        int64_t t0 = esp_timer_get_time();
+        search_->resetStats();
+        Expectimax2048::Result result = search_->think(board, t0 + G2048_SEARCH_MS * 1000, G2048_MAX_DEPTH, &abort_);
+        ESP_LOGD(TAG, "depth %d, %lu boards in %lld us", result.depth,
+                 search_->evaluated(), esp_timer_get_time() - t0);
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (generation == generation_) {
+            result_ = result;
+            ready_ = true;
+        }
+    }
+}
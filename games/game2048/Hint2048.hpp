@@ -0,0 +1,44 @@
+#pragma once
+
+#include "Expectimax2048.hpp"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include <atomic>
+#include <memory>
+#include <mutex>
+
+// Background search for the 2048 hint and autoplay. A low priority task on core 0,
+// where the logic loop sleeps while an event-driven game waits for keys, runs
+// Expectimax2048 for G2048_SEARCH_MS on the latest requested board. A new request
+// or cancel() interrupts the search in flight, so only the newest board is ever
+// answered. The LVGL task polls for the result, nothing calls back into the game.
+class Hint2048 {
+public:
+    static Hint2048& instance();
+
+    // LVGL task. Builds the move tables and starts the task on first use.
+    bool start();
+
+    // LVGL task. Replaces any search in flight.
+    void request(Board2048::Bits board);
+    void cancel();
+
+    // LVGL task. True once when the result for the last request is ready.
+    bool poll(Expectimax2048::Result& result);
+
+private:
+    Hint2048() = default;
+
+    static void taskEntry(void* arg);
+    void run();
+
+    std::mutex mutex_;
+    TaskHandle_t task_ = nullptr;
+    std::unique_ptr<Expectimax2048> search_;
+    std::atomic<bool> abort_{false};
+    uint32_t generation_ = 0;
+    Board2048::Bits board_ = 0;
+    bool pending_ = false;
+    bool ready_ = false;
+    Expectimax2048::Result result_ = {};
+};
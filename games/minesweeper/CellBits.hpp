@@ -0,0 +1,71 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+// One bit per Minesweeper cell, one 64-bit word per row, so boards can be up to
+// 64 cells wide. Neighbourhood operations work on whole rows with shifts: the
+// 8-neighbourhood of a set is three shifted rows ORed into the row above, the row
+// itself and the row below. Storage is sized once in init().
+class CellBits {
+public:
+    static const int MAX_WIDTH = 64;
+
+    void init(int width, int height) {
+        width_ = width;
+        rowMask_ = width >= 64 ? ~0ULL : (1ULL << width) - 1;
+        rows_.assign(height, 0);
+    }
+
+    void clear() {
+        for (auto& row : rows_) {
+            row = 0;
+        }
+    }
+
+    int width() const { return width_; }
+    int height() const { return static_cast<int>(rows_.size()); }
+
+    bool test(int x, int y) const { return (rows_[y] >> x) & 1; }
+    void set(int x, int y) { rows_[y] |= 1ULL << x; }
+    void reset(int x, int y) { rows_[y] &= ~(1ULL << x); }
+
+    uint64_t row(int y) const { return rows_[y]; }
+    void setRow(int y, uint64_t bits) { rows_[y] = bits & rowMask_; }
+
+    bool any() const {
+        for (uint64_t row : rows_) {
+            if (row) return true;
+        }
+        return false;
+    }
+
+    int count() const {
+        int n = 0;
+        for (uint64_t row : rows_) {
+            n += __builtin_popcountll(row);
+        }
+        return n;
+    }
+
+    // Cells of src and their 8 neighbours, src may not be this set
+    void dilate(const CellBits& src) {
+        int h = height();
+        uint64_t above = 0;
+        uint64_t here = h > 0 ? spread(src.rows_[0]) : 0;
+        for (int y = 0; y < h; y++) {
+            uint64_t below = y + 1 < h ? spread(src.rows_[y + 1]) : 0;
+            rows_[y] = (above | here | below) & rowMask_;
+            above = here;
+            here = below;
+        }
+    }
+
+    // Row of a cell and its left and right neighbours
+    uint64_t spread(uint64_t row) const { return (row | (row << 1) | (row >> 1)) & rowMask_; }
+
+private:
+    int width_ = 0;
+    uint64_t rowMask_ = 0;
+    std::vector<uint64_t> rows_;
+};
@@ -0,0 +1,157 @@
+#include "MineGenerator.hpp"
+#include "app_config.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include <algorithm>
+#include <cstdlib>
+
+static const char *TAG = "MineGenerator";
+
+MineGenerator& MineGenerator::instance() {
+    static MineGenerator inst;
+    return inst;
+}
+
+bool MineGenerator::start() {
+    if (task_) {
+        return true;
+    }
+    // Core 0 next to the game logic task, which sleeps between keys in Minesweeper
+    if (xTaskCreatePinnedToCore(taskEntry, "MineGenerator", 4096, this, MINES_GENERATOR_PRIORITY, &task_, 0) != pdPASS) {
+        ESP_LOGE(TAG, "Failed to create the generator task");
+        task_ = nullptr;
+        return false;
+    }
+    return true;
+}
+
+void MineGenerator::taskEntry(void* arg) {
+    static_cast<MineGenerator*>(arg)->run();
+}
+
+void MineGenerator::request(int width, int height, int mines, int x, int y, uint32_t seed) {
+    if (!task_) {
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        generation_++;
+        width_ = width;
+        height_ = height;
+        mines_ = mines;
+        startX_ = x;
+        startY_ = y;
+        seed_ = seed;
+        pending_ = true;
+        ready_ = false;
+        abort_.store(true, std::memory_order_relaxed);
+    }
+    xTaskNotifyGive(task_);
+}
+
+void MineGenerator::cancel() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    generation_++;
+    pending_ = false;
+    ready_ = false;
+    abort_.store(true, std::memory_order_relaxed);
+}
+
+bool MineGenerator::poll(CellBits& mines, Stats& stats) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!ready_) {
+        return false;
+    }
+    ready_ = false;
+    mines = result_;
+    stats = stats_;
+    return true;
+}
+
+void MineGenerator::scatter(CellBits& mines, int count, int x, int y, std::mt19937& rng, std::vector<uint16_t>& cells) {
+    int width = mines.width();
+    int height = mines.height();
+
+    cells.clear();
+    for (int cy = 0; cy < height; cy++) {
+        for (int cx = 0; cx < width; cx++) {
+            if (std::abs(cx - x) > 1 || std::abs(cy - y) > 1) {
+                cells.push_back(static_cast<uint16_t>(cy * width + cx));
+            }
+        }
+    }
+
+    // Partial Fisher-Yates, the first count cells get the mines
+    if (count > static_cast<int>(cells.size())) {
+        count = static_cast<int>(cells.size());
+    }
+    mines.clear();
+    for (int i = 0; i < count; i++) {
+        std::uniform_int_distribution<int> pick(i, static_cast<int>(cells.size()) - 1);
+        std::swap(cells[i], cells[pick(rng)]);
+        mines.set(cells[i] % width, cells[i] / width);
+    }
+}
+
+MineGenerator::Stats MineGenerator::generate(MineSolver& solver, CellBits& mines, int count, int x, int y,
+                                             std::mt19937& rng, int64_t deadlineUs, const std::atomic<bool>* abort) {
+    std::vector<uint16_t> cells;
+    cells.reserve(static_cast<size_t>(mines.width()) * mines.height());
+    count = std::min(count, mines.width() * mines.height() - 9);
+
+    Stats stats = {0, 0, false};
+    int64_t t0 = esp_timer_get_time();
+    do {
+        scatter(mines, count, x, y, rng, cells);
+        stats.boards++;
+        stats.solvable = solver.solve(mines, count, x, y);
+    } while (!stats.solvable && esp_timer_get_time() < deadlineUs &&
+             !(abort && abort->load(std::memory_order_relaxed)));
+    stats.elapsedUs = esp_timer_get_time() - t0;
+    return stats;
+}
+
+void MineGenerator::run() {
+    for (;;) {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+
+        int width, height, mines, x, y;
+        uint32_t seed, generation;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (!pending_) {
+                continue;
+            }
+            pending_ = false;
+            width = width_;
+            height = height_;
+            mines = mines_;
+            x = startX_;
+            y = startY_;
+            seed = seed_;
+            generation = generation_;
+            abort_.store(false, std::memory_order_relaxed);
+        }
+
+        // Sized once per board size, solving reuses the buffers
+        if (board_.width() != width || board_.height() != height) {
+            solver_.init(width, height);
+            board_.init(width, height);
+        }
+
+        rng_.seed(seed);
+        int64_t deadline = esp_timer_get_time() + MINES_NO_GUESS_MS * 1000;
+        Stats stats = generate(solver_, board_, mines, x, y, rng_, deadline, &abort_);
+        ESP_LOGI(TAG, "%dx%d/%d: %s after %lu boards in %lld us, %lld boards/s", width, height, mines,
+                 stats.solvable ? "no-guess board" : "no solvable board, using a random one",
+                 stats.boards, stats.elapsedUs,
+                 stats.elapsedUs > 0 ? stats.boards * 1000000LL / stats.elapsedUs : 0);
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (generation == generation_) {
+            result_ = board_;
+            stats_ = stats;
+            ready_ = true;
+        }
+    }
+}
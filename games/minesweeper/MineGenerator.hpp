@@ -0,0 +1,68 @@
+#pragma once
+
+#include "MineSolver.hpp"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include <atomic>
+#include <mutex>
+#include <random>
+
+// No-guess Minesweeper boards. Mines are scattered after the first click, away from
+// it and its neighbours so it always opens an area, and MineSolver checks that the
+// rest can be cleared by deduction; unsolvable boards are thrown away. The search runs
+// in a low priority task on core 0, where the logic loop sleeps while Minesweeper
+// waits for keys, so the LVGL task keeps animating the first reveal meanwhile. The
+// LVGL task polls for the board, nothing calls back into the game.
+class MineGenerator {
+public:
+    // Boards tried by one search
+    struct Stats {
+        uint32_t boards;
+        int64_t elapsedUs;
+        bool solvable;
+    };
+
+    static MineGenerator& instance();
+
+    // LVGL task. Starts the task on first use.
+    bool start();
+
+    // LVGL task. Replaces any search in flight.
+    void request(int width, int height, int mines, int x, int y, uint32_t seed);
+    void cancel();
+
+    // LVGL task. True once when the board for the last request is ready. Without a
+    // solvable board before MINES_NO_GUESS_MS the last random one is returned.
+    bool poll(CellBits& mines, Stats& stats);
+
+    // Any task. Scatters mines and solves until a board passes, the deadline
+    // (esp_timer_get_time) passes or abort is set. mines holds the last board tried.
+    static Stats generate(MineSolver& solver, CellBits& mines, int count, int x, int y,
+                          std::mt19937& rng, int64_t deadlineUs, const std::atomic<bool>* abort);
+
+private:
+    MineGenerator() = default;
+
+    static void scatter(CellBits& mines, int count, int x, int y, std::mt19937& rng, std::vector<uint16_t>& cells);
+
+    static void taskEntry(void* arg);
+    void run();
+
+    std::mutex mutex_;
+    TaskHandle_t task_ = nullptr;
+    std::atomic<bool> abort_{false};
+    uint32_t generation_ = 0;
+    int width_ = 0;
+    int height_ = 0;
+    int mines_ = 0;
+    int startX_ = 0;
+    int startY_ = 0;
+    uint32_t seed_ = 0;
+    bool pending_ = false;
+    bool ready_ = false;
+    MineSolver solver_;         // task only
+    CellBits board_;            // task only
+    std::mt19937 rng_;          // task only, too big for its stack
+    CellBits result_;
+    Stats stats_ = {};
+};
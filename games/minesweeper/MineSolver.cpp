@@ -0,0 +1,225 @@
+#include "MineSolver.hpp"
+
+// Columns x - 1 .. x + 1
+static inline uint64_t column3(int x) {
+    return x > 0 ? 7ULL << (x - 1) : 3ULL;
+}
+
+void MineSolver::init(int width, int height) {
+    width_ = width;
+    height_ = height;
+    rowMask_ = width >= 64 ? ~0ULL : (1ULL << width) - 1;
+
+    size_t cells = static_cast<size_t>(width) * height;
+    counts_.assign(cells, 0);
+    zeros_.init(width, height);
+    open_.init(width, height);
+    known_.init(width, height);
+    frontier_.init(width, height);
+    next_.init(width, height);
+    safe_.init(width, height);
+    active_.clear();
+    active_.reserve(cells);
+    activeAt_.assign(cells, -1);
+}
+
+bool MineSolver::solve(const CellBits& mines, int mineCount, int x, int y) {
+    computeCounts(mines);
+    open_.clear();
+    known_.clear();
+
+    safe_.clear();
+    safe_.set(x, y);
+    open(safe_);
+
+    int safeCells = width_ * height_ - mineCount;
+    while (open_.count() < safeCells) {
+        if (!singlePoint() && !subsets() && !globalCount(mineCount)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void MineSolver::computeCounts(const CellBits& mines) {
+    zeros_.clear();
+    for (int y = 0; y < height_; y++) {
+        uint64_t above = y > 0 ? mines.row(y - 1) : 0;
+        uint64_t here = mines.row(y);
+        uint64_t below = y + 1 < height_ ? mines.row(y + 1) : 0;
+        for (int x = 0; x < width_; x++) {
+            uint64_t m = column3(x);
+            int n = __builtin_popcountll(above & m) + __builtin_popcountll(here & m) + __builtin_popcountll(below & m);
+            bool mine = (here >> x) & 1;
+            counts_[y * width_ + x] = static_cast<uint8_t>(mine ? 0 : n);
+            if (!mine && n == 0) {
+                zeros_.set(x, y);
+            }
+        }
+    }
+}
+
+// Opens the cells and, through zeros, everything a click on them would open
+void MineSolver::open(const CellBits& cells) {
+    for (int y = 0; y < height_; y++) {
+        frontier_.setRow(y, cells.row(y) & ~open_.row(y));
+    }
+    while (frontier_.any()) {
+        for (int y = 0; y < height_; y++) {
+            open_.setRow(y, open_.row(y) | frontier_.row(y));
+            frontier_.setRow(y, frontier_.row(y) & zeros_.row(y));
+        }
+        next_.dilate(frontier_);
+        for (int y = 0; y < height_; y++) {
+            frontier_.setRow(y, next_.row(y) & ~open_.row(y));
+        }
+    }
+}
+
+MineSolver::Window MineSolver::hiddenAround(int x, int y) const {
+    Window w = {y, {0, 0, 0}};
+    uint64_t m = column3(x) & rowMask_;
+    for (int r = 0; r < 3; r++) {
+        int yy = y + r - 1;
+        if (yy >= 0 && yy < height_) {
+            w.rows[r] = ~open_.row(yy) & ~known_.row(yy) & m;
+        }
+    }
+    return w;
+}
+
+int MineSolver::minesLeft(int x, int y) const {
+    uint64_t m = column3(x);
+    int found = 0;
+    for (int yy = y - 1; yy <= y + 1; yy++) {
+        if (yy >= 0 && yy < height_) {
+            found += __builtin_popcountll(known_.row(yy) & m);
+        }
+    }
+    return counts_[y * width_ + x] - found;
+}
+
+void MineSolver::addWindow(CellBits& set, const Window& w) const {
+    for (int r = 0; r < 3; r++) {
+        int yy = w.y + r - 1;
+        if (w.rows[r] && yy >= 0 && yy < height_) {
+            set.setRow(yy, set.row(yy) | w.rows[r]);
+        }
+    }
+}
+
+// Open numbers next to hidden cells: all their mines found, or all hidden cells are mines.
+// Also collects active_ for the subset rule.
+bool MineSolver::singlePoint() {
+    for (int y = 0; y < height_; y++) {
+        safe_.setRow(y, ~open_.row(y) & ~known_.row(y));
+    }
+    next_.dilate(safe_);
+    safe_.clear();
+
+    for (uint16_t cell : active_) {
+        activeAt_[cell] = -1;
+    }
+    active_.clear();
+
+    bool marked = false;
+    for (int y = 0; y < height_; y++) {
+        for (uint64_t bits = next_.row(y) & open_.row(y); bits; bits &= bits - 1) {
+            int x = __builtin_ctzll(bits);
+            Window hidden = hiddenAround(x, y);
+            int n = count(hidden);
+            int left = minesLeft(x, y);
+            if (left == 0) {
+                addWindow(safe_, hidden);
+            } else if (left == n) {
+                addWindow(known_, hidden);
+                marked = true;
+            } else {
+                uint16_t cell = static_cast<uint16_t>(y * width_ + x);
+                activeAt_[cell] = static_cast<int16_t>(active_.size());
+                active_.push_back(cell);
+            }
+        }
+    }
+
+    if (safe_.any()) {
+        open(safe_);
+        return true;
+    }
+    return marked;
+}
+
+// For numbers A and B within two cells whose hidden sets nest (A in B), the
+// cells only B sees hold exactly left(B) - left(A) mines.
+bool MineSolver::subsets() {
+    safe_.clear();
+    bool marked = false;
+
+    for (uint16_t a : active_) {
+        int ax = a % width_;
+        int ay = a / width_;
+        Window wa = hiddenAround(ax, ay);
+        int leftA = minesLeft(ax, ay);
+
+        for (int by = ay - 2; by <= ay + 2; by++) {
+            if (by < 0 || by >= height_) continue;
+            for (int bx = ax - 2; bx <= ax + 2; bx++) {
+                if (bx < 0 || bx >= width_ || (bx == ax && by == ay)) continue;
+                int b = activeAt_[by * width_ + bx];
+                if (b < 0) continue;
+
+                Window wb = hiddenAround(bx, by);
+                bool nested = true;
+                for (int yy = ay - 1; yy <= ay + 1 && nested; yy++) {
+                    nested = (windowRow(wa, yy) & ~windowRow(wb, yy)) == 0;
+                }
+                if (!nested) continue;
+
+                Window extra = wb;
+                for (int r = 0; r < 3; r++) {
+                    extra.rows[r] &= ~windowRow(wa, wb.y + r - 1);
+                }
+                int n = count(extra);
+                if (n == 0) continue;
+
+                int left = minesLeft(bx, by) - leftA;
+                if (left == 0) {
+                    addWindow(safe_, extra);
+                } else if (left == n) {
+                    addWindow(known_, extra);
+                    marked = true;
+                }
+            }
+        }
+    }
+
+    if (safe_.any()) {
+        open(safe_);
+        return true;
+    }
+    return marked;
+}
+
+// All mines found frees every hidden cell, as many hidden cells as mines left marks them
+bool MineSolver::globalCount(int mineCount) {
+    int left = mineCount - known_.count();
+    int hidden = 0;
+    for (int y = 0; y < height_; y++) {
+        safe_.setRow(y, ~open_.row(y) & ~known_.row(y));
+        hidden += __builtin_popcountll(safe_.row(y));
+    }
+    if (hidden == 0) {
+        return false;
+    }
+    if (left == 0) {
+        open(safe_);
+        return true;
+    }
+    if (left == hidden) {
+        for (int y = 0; y < height_; y++) {
+            known_.setRow(y, known_.row(y) | safe_.row(y));
+        }
+        return true;
+    }
+    return false;
+}
@@ -0,0 +1,58 @@
+#pragma once
+
+#include "CellBits.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Checks that a Minesweeper board can be cleared from a first click without
+// guessing. It plays like a careful player on bitsets: open the start, then apply
+// the single-point rules (a number whose mines are all known frees its other
+// hidden neighbours, one that needs all of them marks them as mines) and, when
+// those stall, the subset rule between nearby numbers whose hidden neighbours
+// nest, and finally the total mine count. Hidden neighbourhoods are three row
+// masks, so every rule is a few word operations.
+class MineSolver {
+public:
+    void init(int width, int height);
+
+    // True when every safe cell gets opened
+    bool solve(const CellBits& mines, int mineCount, int x, int y);
+
+private:
+    // Hidden, unmarked cells around one number, rows y - 1 .. y + 1
+    struct Window {
+        int y;
+        uint64_t rows[3];
+    };
+
+    Window hiddenAround(int x, int y) const;
+    int minesLeft(int x, int y) const;
+    uint64_t windowRow(const Window& w, int y) const {
+        return y >= w.y - 1 && y <= w.y + 1 ? w.rows[y - w.y + 1] : 0;
+    }
+    static int count(const Window& w) {
+        return __builtin_popcountll(w.rows[0]) + __builtin_popcountll(w.rows[1]) + __builtin_popcountll(w.rows[2]);
+    }
+    void addWindow(CellBits& set, const Window& w) const;
+
+    void computeCounts(const CellBits& mines);
+    void open(const CellBits& cells);
+    bool singlePoint();
+    bool subsets();
+    bool globalCount(int mineCount);
+
+    int width_ = 0;
+    int height_ = 0;
+    uint64_t rowMask_ = 0;
+
+    std::vector<uint8_t> counts_;
+    CellBits zeros_;
+    CellBits open_;
+    CellBits known_;        // deduced mines
+    CellBits frontier_;
+    CellBits next_;
+    CellBits safe_;
+    std::vector<uint16_t> active_;  // open numbers with hidden neighbours, y * width + x
+    std::vector<int16_t> activeAt_; // index in active_ by cell, -1 if none
+};
@@ -1,19 +1,39 @@
 #include "Minesweeper.hpp"
+#include "MineGenerator.hpp"
 #include "GameRegistry.hpp"
 #include "lvgl_helper.hpp"
+#include "DeferredDeleter.hpp"
+#include "app_config.h"
+#include "esp_heap_caps.h"
+#include "esp_log.h"
 #include <cstdio>
 #include <algorithm>
-#include <queue>
 #include "lvgl/src/misc/lv_timer.h"
 
+static const char *TAG = "Minesweeper";
+
+static const lv_color_format_t TILE_FORMAT = LV_COLOR_FORMAT_RGB565;
+
+const MinesweeperConfig Minesweeper::BEGINNER = {"Minesweeper", 9, 9, 10, 30};
+const MinesweeperConfig Minesweeper::EXPERT = {"Minesweeper Expert", 30, 16, 99, 20};
+// Expert density on a board that needs the viewport both ways
+const MinesweeperConfig Minesweeper::XL = {"Minesweeper XL", 50, 50, 500, 20};
+
 RegisterMinesweeper::RegisterMinesweeper() {
-    GameRegistry::instance().registerGame("Minesweeper", []() {
-        return std::make_unique<Minesweeper>();
+    GameRegistry::instance().registerGame(Minesweeper::BEGINNER.name, []() {
+        return std::make_unique<Minesweeper>(Minesweeper::BEGINNER);
+    });
+    GameRegistry::instance().registerGame(Minesweeper::EXPERT.name, []() {
+        return std::make_unique<Minesweeper>(Minesweeper::EXPERT);
+    });
+    GameRegistry::instance().registerGame(Minesweeper::XL.name, []() {
+        return std::make_unique<Minesweeper>(Minesweeper::XL);
     });
 }
 
-Minesweeper::Minesweeper()
-    : cursorX_(0),
+Minesweeper::Minesweeper(const MinesweeperConfig& config)
+    : config_(config),
+      cursorX_(0),
       cursorY_(0),
       flagCount_(0),
       revealedCount_(0),
@@ -30,7 +50,22 @@ Minesweeper::~Minesweeper() {
 }
 
 void Minesweeper::run() {
+    grid_.assign(config_.gridWidth * config_.gridHeight, Cell{false, 0, HIDDEN});
+    zeros_.init(config_.gridWidth, config_.gridHeight);
+    open_.init(config_.gridWidth, config_.gridHeight);
+    frontier_.init(config_.gridWidth, config_.gridHeight);
+    next_.init(config_.gridWidth, config_.gridHeight);
+    pending_.init(config_.gridWidth, config_.gridHeight);
+    mines_.init(config_.gridWidth, config_.gridHeight);
+    // A cell is in at most one ring of a reveal
+    ringCells_.reserve(grid_.size());
+    ringStarts_.reserve(grid_.size());
     createGameScreen();
+    if (!createTiles()) {
+        ESP_LOGE(TAG, "No memory for the tile images");
+        lv_label_set_text(statusLabel_, "Out of memory");
+        return;
+    }
     resetGame();
     gameRunning_ = true;
 }
@@ -43,119 +78,219 @@ void Minesweeper::stop() {
     if (stopped_ == true) return;
     stopped_ = true;
     gameRunning_ = false;
+
+    if (generating_) {
+        MineGenerator::instance().cancel();
+        generating_ = false;
+    }
+    if (revealTimer_) {
+        lv_timer_del(revealTimer_);
+        revealTimer_ = nullptr;
+    }
+
+    // The board draws from the tile strip, it goes first
+    if (gameBoard_) {
+        lv_obj_del(gameBoard_);
+        gameBoard_ = nullptr;
+    }
+    if (tileData_) {
+        heap_caps_free(tileData_);
+        tileData_ = nullptr;
+    }
     
     if (screen_) {
-        lv_obj_del(screen_);
+        DeferredDeleter::instance().enqueue(screen_);
         screen_ = nullptr;
     }
 }
 
-void Minesweeper::processRevealStep() {
-    int steps = 0;
-    const int MAX_STEPS = 10;
-
-    while (!revealQueue_.empty() && steps < MAX_STEPS) {
-        auto [x, y] = revealQueue_.front();
-        revealQueue_.pop();
-        steps++;
+// Computes the whole region the reveal opens, ring by ring outwards from (x, y).
+// A ring is the cells first reached at that distance, the wave only passes
+// through cells without adjacent mines.
+void Minesweeper::startRevealFrom(int x, int y) {
+    if (x < 0 || x >= config_.gridWidth || y < 0 || y >= config_.gridHeight) return;
 
-        if (x < 0 || x >= GRID_WIDTH || y < 0 || y >= GRID_HEIGHT) continue;
+    finishReveal();
 
-        Cell& cell = grid_[y][x];
+    if (cellAt(x, y).hasMine) {
+        cellAt(x, y).state = REVEALED;
+        open_.set(x, y);
+        invalidateCell(x, y);
+        revealAllMines();
+        gameOver(false);
+        return;
+    }
 
-        if (cell.state == REVEALED) continue;
+    ringCells_.clear();
+    ringStarts_.clear();
+    ringIndex_ = 0;
+    int flagsBefore = totalFlags_;
+
+    frontier_.clear();
+    frontier_.set(x, y);
+    while (frontier_.any()) {
+        ringStarts_.push_back(static_cast<uint16_t>(ringCells_.size()));
+
+        for (int cy = 0; cy < config_.gridHeight; cy++) {
+            for (uint64_t bits = frontier_.row(cy); bits; bits &= bits - 1) {
+                int cx = __builtin_ctzll(bits);
+                Cell& cell = cellAt(cx, cy);
+                // Flags in the way are cleared, as before
+                if (cell.state == FLAGGED) {
+                    totalFlags_--;
+                }
+                cell.state = REVEALED;
+                revealedCount_++;
+                open_.set(cx, cy);
+                pending_.set(cx, cy);
+                ringCells_.push_back(static_cast<uint16_t>(cy * config_.gridWidth + cx));
+            }
+        }
 
-        if (cell.state == FLAGGED) {
-            cell.state = HIDDEN;
-            totalFlags_--;
-            lv_label_set_text(cell.label, "");
-            lv_obj_set_style_bg_color(cell.obj, lv_color_make(180, 180, 180), 0);
-            updateDisplay();
+        // Next ring: neighbours of the zero cells just opened that are still closed
+        for (int cy = 0; cy < config_.gridHeight; cy++) {
+            frontier_.setRow(cy, frontier_.row(cy) & zeros_.row(cy));
+        }
+        next_.dilate(frontier_);
+        for (int cy = 0; cy < config_.gridHeight; cy++) {
+            frontier_.setRow(cy, next_.row(cy) & ~open_.row(cy));
         }
+    }
 
-        if (cell.state != HIDDEN) continue;
+    if (totalFlags_ != flagsBefore) {
+        updateDisplay();
+    }
 
-        cell.state = REVEALED;
-        revealedCount_++;
+    revealStep();
+    if (ringIndex_ < ringStarts_.size()) {
+        revealTimer_ = lv_timer_create(revealTimerCallback, RING_PERIOD_MS, this);
+    } else {
+        checkWin();
+    }
+}
 
-        if (cell.hasMine) {
-            lv_label_set_text(cell.label, "*");
-            lv_obj_set_style_bg_color(cell.obj, lv_color_make(255, 0, 0), 0);
-            lv_obj_set_style_text_color(cell.label, lv_color_make(255, 255, 255), 0);
-            revealAllMines();
-            gameOver(false);
-            lv_timer_del(revealTimer_);
-            revealTimer_ = nullptr;
-            return;
-        }
+// Shows the next ring with one invalidation of its bounding box
+void Minesweeper::revealStep() {
+    if (ringIndex_ >= ringStarts_.size()) return;
+
+    size_t first = ringStarts_[ringIndex_];
+    size_t last = ++ringIndex_ < ringStarts_.size() ? ringStarts_[ringIndex_] : ringCells_.size();
+
+    int x1 = config_.gridWidth, y1 = config_.gridHeight, x2 = -1, y2 = -1;
+    for (size_t i = first; i < last; i++) {
+        int x = ringCells_[i] % config_.gridWidth;
+        int y = ringCells_[i] / config_.gridWidth;
+        pending_.reset(x, y);
+        x1 = std::min(x1, x);
+        y1 = std::min(y1, y);
+        x2 = std::max(x2, x);
+        y2 = std::max(y2, y);
+    }
 
-        lv_obj_set_style_bg_color(cell.obj, lv_color_make(140, 140, 140), 0);
-        lv_label_set_text(cell.label, "");
-
-        if (cell.adjacentMines > 0) {
-            char text[12];
-            snprintf(text, sizeof(text), "%d", cell.adjacentMines);
-            lv_label_set_text(cell.label, text);
-            lv_obj_set_style_text_color(cell.label, getNumberColor(cell.adjacentMines), 0);
-        } else {
-            for (int dy = -1; dy <= 1; dy++) {
-                for (int dx = -1; dx <= 1; dx++) {
-                    if (dx == 0 && dy == 0) continue;
-                    revealQueue_.push({x + dx, y + dy});
-                }
-            }
-        }
+    // Clipped to the viewport, cells outside it are drawn when panned to
+    x1 = std::max(x1, viewX_);
+    y1 = std::max(y1, viewY_);
+    x2 = std::min(x2, viewX_ + viewCols_ - 1);
+    y2 = std::min(y2, viewY_ + viewRows_ - 1);
+    if (x1 <= x2 && y1 <= y2) {
+        lv_area_t coords;
+        lv_obj_get_coords(gameBoard_, &coords);
+        int32_t originX = coords.x1 + BOARD_BORDER;
+        int32_t originY = coords.y1 + BOARD_BORDER;
+        lv_area_t area = {
+            originX + (x1 - viewX_) * config_.cellSize, originY + (y1 - viewY_) * config_.cellSize,
+            originX + (x2 - viewX_ + 1) * config_.cellSize - 1, originY + (y2 - viewY_ + 1) * config_.cellSize - 1
+        };
+        lv_obj_invalidate_area(gameBoard_, &area);
     }
+}
 
-    if (revealQueue_.empty()) {
-        checkWin();
-        lv_timer_del(revealTimer_);
-        revealTimer_ = nullptr;
+// Shows whatever is left of a running reveal at once
+void Minesweeper::finishReveal() {
+    if (!revealTimer_) return;
+
+    lv_timer_del(revealTimer_);
+    revealTimer_ = nullptr;
+    while (ringIndex_ < ringStarts_.size()) {
+        revealStep();
     }
 }
 
-void processRevealStepAdapter(lv_timer_t* timer) {
-    auto* self = static_cast<Minesweeper*>(lv_timer_get_user_data(timer));
-    self->processRevealStep();
+// Asks for a no-guess board around the first click. The clicked cell is a zero on
+// any board the generator makes, so it opens right away; the rest of the reveal
+// starts when the board arrives.
+bool Minesweeper::startGeneration(int x, int y) {
+    if (!MineGenerator::instance().start()) {
+        return false;
+    }
+
+    generating_ = true;
+    startX_ = x;
+    startY_ = y;
+    MineGenerator::instance().request(config_.gridWidth, config_.gridHeight, config_.mines, x, y, gen_());
+
+    cellAt(x, y).state = REVEALED;
+    invalidateCell(x, y);
+    revealTimer_ = lv_timer_create(revealTimerCallback, RING_PERIOD_MS, this);
+    return true;
 }
 
-void Minesweeper::startRevealFrom(int x, int y) {
-    if (x < 0 || x >= GRID_WIDTH || y < 0 || y >= GRID_HEIGHT) return;
+void Minesweeper::generationStep() {
+    MineGenerator::Stats stats;
+    if (!MineGenerator::instance().poll(mines_, stats)) return;
 
-    revealQueue_ = {};
-    revealQueue_.push({x, y});
+    generating_ = false;
+    lv_timer_del(revealTimer_);
+    revealTimer_ = nullptr;
 
-    if (revealTimer_) {
-        lv_timer_del(revealTimer_);
+    for (int y = 0; y < config_.gridHeight; y++) {
+        for (int x = 0; x < config_.gridWidth; x++) {
+            cellAt(x, y).hasMine = mines_.test(x, y);
+        }
     }
+    calculateNumbers();
+
+    cellAt(startX_, startY_).state = HIDDEN;
+    startRevealFrom(startX_, startY_);
+}
 
-    revealTimer_ = lv_timer_create(processRevealStepAdapter, 30, nullptr);
-    lv_timer_set_user_data(revealTimer_, this);
+void Minesweeper::revealTimerCallback(lv_timer_t* timer) {
+    auto* self = static_cast<Minesweeper*>(lv_timer_get_user_data(timer));
+    if (self->generating_) {
+        self->generationStep();
+        return;
+    }
+    self->revealStep();
+    if (self->ringIndex_ >= self->ringStarts_.size()) {
+        lv_timer_del(self->revealTimer_);
+        self->revealTimer_ = nullptr;
+        self->checkWin();
+    }
 }
 
 void Minesweeper::handleKey(uint32_t key) {
     if (!gameRunning_) return;
 
-    auto &old = grid_[cursorY_][cursorX_];
-    lv_obj_set_style_border_width(old.obj, 1, 0);
-    lv_obj_set_style_border_color(old.obj, lv_color_make(128,128,128), 0);
+    invalidateCell(cursorX_, cursorY_);
 
     switch (key) {
         case LV_KEY_UP:
             cursorY_ = std::max(0, cursorY_ - 1);
             break;
         case LV_KEY_DOWN:
-            cursorY_ = std::min(GRID_HEIGHT - 1, cursorY_ + 1);
+            cursorY_ = std::min(config_.gridHeight - 1, cursorY_ + 1);
             break;
         case LV_KEY_LEFT:
             cursorX_ = std::max(0, cursorX_ - 1);
             break;
         case LV_KEY_RIGHT:
-            cursorX_ = std::min(GRID_WIDTH - 1, cursorX_ + 1);
+            cursorX_ = std::min(config_.gridWidth - 1, cursorX_ + 1);
             break;
         case LV_KEY_ENTER:
             {
-                Cell& cell = grid_[cursorY_][cursorX_];
+                if (generating_) break;
+
+                Cell& cell = cellAt(cursorX_, cursorY_);
                 if (cell.state == HIDDEN) {
                     toggleFlag(cursorX_, cursorY_);
                 } else if (cell.state == FLAGGED) {
@@ -165,6 +300,8 @@ void Minesweeper::handleKey(uint32_t key) {
                     
                     if (firstClick_) {
                         firstClick_ = false;
+                        // The reveal starts once the board is ready
+                        if (startGeneration(cursorX_, cursorY_)) break;
                         placeMines();
                         calculateNumbers();
                     }
@@ -173,22 +310,18 @@ void Minesweeper::handleKey(uint32_t key) {
             }
     }
 
-    auto &n = grid_[cursorY_][cursorX_];
-    lv_obj_set_style_border_width(n.obj, 3, 0);
-    lv_obj_set_style_border_color(n.obj, lv_color_make(0, 0, 255), 0);
+    panToCursor();
+    invalidateCell(cursorX_, cursorY_);
 }
 
 void Minesweeper::createGameScreen() {
-    const int SCREEN_W         = 320;
-    const int TOP_OFFSET       = 120;
-    const int CELL_BORDER      = 1;
-    const int CONTAINER_BORDER = 2;
-    const int PADDING          = 8;
+    const int cell = config_.cellSize;
+    viewCols_ = std::min(config_.gridWidth, (DISP_WIDTH - 2 * BOARD_BORDER - 8) / cell);
+    viewRows_ = std::min(config_.gridHeight, (BOARD_BOTTOM - BOARD_TOP - 2 * BOARD_BORDER) / cell);
+    viewX_ = viewY_ = 0;
 
-    const int gridW = GRID_WIDTH  * CELL_SIZE;
-    const int gridH = GRID_HEIGHT * CELL_SIZE;
-    const int boardW = gridW + PADDING + CELL_BORDER*2;
-    const int boardH = gridH + PADDING + CELL_BORDER*2;
+    const int boardW = viewCols_ * cell + 2 * BOARD_BORDER;
+    const int boardH = viewRows_ * cell + 2 * BOARD_BORDER;
 
     screen_ = createCleanObject(nullptr);
     lv_obj_set_style_bg_color(screen_, lv_color_make(50, 50, 50), 0);
@@ -196,7 +329,7 @@ void Minesweeper::createGameScreen() {
     statusLabel_ = lv_label_create(screen_);
     applyCleanStyle(statusLabel_);
     lv_obj_set_pos(statusLabel_, 10, 10);
-    lv_label_set_text(statusLabel_, "Minesweeper");
+    lv_label_set_text(statusLabel_, config_.name);
     lv_obj_set_style_text_font(statusLabel_, &lv_font_montserrat_20, 0);
 
     mineCountLabel_ = lv_label_create(screen_);
@@ -204,46 +337,15 @@ void Minesweeper::createGameScreen() {
     lv_obj_set_pos(mineCountLabel_, 10, 40);
     lv_obj_set_style_text_font(mineCountLabel_, &lv_font_montserrat_20, 0);
 
+    // Cells are drawn by drawCallback over the plain background
     gameBoard_ = createCleanObject(screen_);
     lv_obj_set_size(gameBoard_, boardW, boardH);
-    lv_obj_set_pos(gameBoard_, (SCREEN_W - boardW)/2, TOP_OFFSET);
-    lv_obj_set_style_border_width(gameBoard_, CONTAINER_BORDER, 0);
+    lv_obj_set_pos(gameBoard_, (DISP_WIDTH - boardW) / 2, BOARD_TOP + (BOARD_BOTTOM - BOARD_TOP - boardH) / 2);
+    lv_obj_set_style_border_width(gameBoard_, BOARD_BORDER, 0);
+    lv_obj_set_style_radius(gameBoard_, 0, 0);
     lv_obj_set_style_bg_color(gameBoard_, lv_color_make(128,128,128), 0);
     lv_obj_set_style_bg_opa(gameBoard_, LV_OPA_COVER, 0);
-
-    const int inner = PADDING/2 + CELL_BORDER;
-
-    for (int y = 0; y < GRID_HEIGHT; y++) {
-        for (int x = 0; x < GRID_WIDTH; x++) {
-            Cell &c = grid_[y][x];
-            c.obj = createCleanObject(gameBoard_);
-            lv_obj_set_size(c.obj, CELL_SIZE - 1, CELL_SIZE - 1);
-            lv_obj_set_pos(c.obj,
-                inner + x*CELL_SIZE,
-                inner + y*CELL_SIZE
-            );
-
-            lv_obj_set_style_bg_color(c.obj, lv_color_make(180,180,180), 0);
-            lv_obj_set_style_bg_opa(c.obj, LV_OPA_COVER, 0);
-            lv_obj_set_style_border_width(c.obj, 1, 0);
-            lv_obj_set_style_border_color(c.obj, lv_color_make(100,100,100), 0);
-            lv_obj_set_style_radius(c.obj, 2, 0);
-
-            c.label = lv_label_create(c.obj);
-            applyCleanStyle(c.label);
-            lv_label_set_text(c.label, "");
-            lv_obj_center(c.label);
-            lv_obj_set_style_text_font(c.label, &lv_font_montserrat_14, 0);
-
-            c.hasMine = false;
-            c.adjacentMines = 0;
-            c.state = HIDDEN;
-        }
-    }
-
-    cursorX_ = cursorY_ = 0;
-    lv_obj_set_style_border_width(grid_[0][0].obj, 3, 0);
-    lv_obj_set_style_border_color(grid_[0][0].obj, lv_color_make(0, 0, 255), 0);
+    lv_obj_add_event_cb(gameBoard_, drawCallback, LV_EVENT_DRAW_MAIN, this);
 
     lv_obj_t* instr = lv_label_create(screen_);
     applyCleanStyle(instr);
@@ -258,36 +360,217 @@ void Minesweeper::createGameScreen() {
     lv_obj_set_style_text_align(instr, LV_TEXT_ALIGN_CENTER, 0);
 
     lv_scr_load(screen_);
+    // Coordinates are needed for the first cell invalidations
+    lv_obj_update_layout(gameBoard_);
+}
+
+// Renders every tile once into a vertical strip with a temporary canvas
+bool Minesweeper::createTiles() {
+    const int size = config_.cellSize;
+    uint32_t stride = lv_draw_buf_width_to_stride(size, TILE_FORMAT);
+    uint32_t tileBytes = stride * size;
+    uint32_t bytes = tileBytes * TILE_COUNT;
+
+    tileData_ = heap_caps_aligned_alloc(LV_DRAW_BUF_ALIGN, bytes, MALLOC_CAP_SPIRAM);
+    if (!tileData_) {
+        return false;
+    }
+    lv_draw_buf_init(&tileBuf_, size, size * TILE_COUNT, TILE_FORMAT, stride, tileData_, bytes);
+
+    lv_obj_t* canvas = lv_canvas_create(nullptr);
+    lv_canvas_set_draw_buf(canvas, &tileBuf_);
+    // The 1 px the cell is smaller than its pitch is the board background
+    lv_canvas_fill_bg(canvas, lv_color_make(128, 128, 128), LV_OPA_COVER);
+
+    lv_layer_t layer;
+    lv_canvas_init_layer(canvas, &layer);
+
+    for (int t = 0; t < TILE_COUNT; t++) {
+        lv_color_t bg = lv_color_make(200, 200, 200);
+        lv_color_t fg = lv_color_make(0, 0, 0);
+        const char* text = "";
+        switch (t) {
+            case TILE_HIDDEN:     break;
+            case TILE_FLAG:       bg = lv_color_make(255, 200, 200); fg = lv_color_make(0, 0, 255); text = "F"; break;
+            case TILE_FLAG_WIN:   bg = lv_color_make(200, 255, 200); fg = lv_color_make(0, 255, 0); text = "F"; break;
+            case TILE_FLAG_WRONG: bg = lv_color_make(255, 200, 200); text = "X"; break;
+            case TILE_MINE:       bg = lv_color_make(0, 0, 200); fg = lv_color_make(255, 255, 255); text = "*"; break;
+            case TILE_MINE_HIT:   bg = lv_color_make(255, 0, 0); fg = lv_color_make(255, 255, 255); text = "*"; break;
+            default: {
+                static const char* const NUMBERS[9] = {"", "1", "2", "3", "4", "5", "6", "7", "8"};
+                int n = t - TILE_OPEN_0;
+                bg = lv_color_make(140, 140, 140);
+                fg = getNumberColor(n);
+                text = NUMBERS[n];
+                break;
+            }
+        }
+
+        lv_area_t area = {0, t * size, size - 2, t * size + size - 2};
+
+        lv_draw_rect_dsc_t rect;
+        lv_draw_rect_dsc_init(&rect);
+        rect.bg_color = bg;
+        rect.radius = 2;
+        rect.border_width = 1;
+        rect.border_color = lv_color_make(100, 100, 100);
+        lv_draw_rect(&layer, &rect, &area);
+
+        if (text[0]) {
+            lv_draw_label_dsc_t label;
+            lv_draw_label_dsc_init(&label);
+            label.font = &lv_font_montserrat_14;
+            label.color = fg;
+            label.align = LV_TEXT_ALIGN_CENTER;
+            label.text = text;
+            int32_t top = area.y1 + (size - 1 - lv_font_get_line_height(label.font)) / 2;
+            lv_area_t textArea = {area.x1, top, area.x2, area.y2};
+            lv_draw_label(&layer, &label, &textArea);
+        }
+    }
+
+    lv_canvas_finish_layer(canvas, &layer);
+    lv_obj_delete(canvas);
+
+    for (int t = 0; t < TILE_COUNT; t++) {
+        lv_image_dsc_t& tile = tiles_[t];
+        tile.header.magic = LV_IMAGE_HEADER_MAGIC;
+        tile.header.cf = TILE_FORMAT;
+        tile.header.w = size;
+        tile.header.h = size;
+        tile.header.stride = stride;
+        tile.data_size = tileBytes;
+        tile.data = static_cast<const uint8_t*>(tileData_) + t * tileBytes;
+    }
+    return true;
+}
+
+Minesweeper::Tile Minesweeper::tileFor(int x, int y) {
+    const Cell& cell = cellAt(x, y);
+    if (pending_.test(x, y)) {
+        return TILE_HIDDEN;
+    }
+    switch (cell.state) {
+        case REVEALED:
+            return cell.hasMine ? TILE_MINE_HIT : static_cast<Tile>(TILE_OPEN_0 + cell.adjacentMines);
+        case FLAGGED:
+            if (won_) return TILE_FLAG_WIN;
+            return showMines_ && !cell.hasMine ? TILE_FLAG_WRONG : TILE_FLAG;
+        default:
+            return showMines_ && cell.hasMine ? TILE_MINE : TILE_HIDDEN;
+    }
+}
+
+void Minesweeper::invalidateCell(int x, int y) {
+    if (!gameBoard_ || x < viewX_ || x >= viewX_ + viewCols_ || y < viewY_ || y >= viewY_ + viewRows_) {
+        return;
+    }
+
+    lv_area_t coords;
+    lv_obj_get_coords(gameBoard_, &coords);
+    int32_t left = coords.x1 + BOARD_BORDER + (x - viewX_) * config_.cellSize;
+    int32_t top = coords.y1 + BOARD_BORDER + (y - viewY_) * config_.cellSize;
+    lv_area_t area = {left, top, left + config_.cellSize - 1, top + config_.cellSize - 1};
+    lv_obj_invalidate_area(gameBoard_, &area);
+}
+
+// Keeps PAN_MARGIN cells around the cursor, a pan redraws the whole viewport
+void Minesweeper::panToCursor() {
+    int margin = std::min(PAN_MARGIN, (std::min(viewCols_, viewRows_) - 1) / 2);
+    int x = viewX_;
+    int y = viewY_;
+
+    if (cursorX_ < x + margin) x = cursorX_ - margin;
+    if (cursorX_ >= x + viewCols_ - margin) x = cursorX_ - viewCols_ + margin + 1;
+    if (cursorY_ < y + margin) y = cursorY_ - margin;
+    if (cursorY_ >= y + viewRows_ - margin) y = cursorY_ - viewRows_ + margin + 1;
+    x = std::max(0, std::min(x, config_.gridWidth - viewCols_));
+    y = std::max(0, std::min(y, config_.gridHeight - viewRows_));
+
+    if (x != viewX_ || y != viewY_) {
+        viewX_ = x;
+        viewY_ = y;
+        lv_obj_invalidate(gameBoard_);
+    }
 }
 
+// Only the cells overlapping the area being redrawn are blitted
+void Minesweeper::drawBoard(lv_layer_t* layer) {
+    if (!tileData_) return;
+
+    const int size = config_.cellSize;
+    lv_area_t coords;
+    lv_obj_get_coords(gameBoard_, &coords);
+    int32_t originX = coords.x1 + BOARD_BORDER;
+    int32_t originY = coords.y1 + BOARD_BORDER;
+
+    const lv_area_t& clip = layer->_clip_area;
+    int col0 = std::max(0, static_cast<int>((clip.x1 - originX) / size));
+    int row0 = std::max(0, static_cast<int>((clip.y1 - originY) / size));
+    int col1 = std::min(viewCols_ - 1, static_cast<int>((clip.x2 - originX) / size));
+    int row1 = std::min(viewRows_ - 1, static_cast<int>((clip.y2 - originY) / size));
+
+    lv_draw_image_dsc_t image;
+    lv_draw_image_dsc_init(&image);
+
+    for (int row = row0; row <= row1; row++) {
+        for (int col = col0; col <= col1; col++) {
+            image.src = &tiles_[tileFor(viewX_ + col, viewY_ + row)];
+            lv_area_t area = {originX + col * size, originY + row * size,
+                              originX + col * size + size - 1, originY + row * size + size - 1};
+            lv_draw_image(layer, &image, &area);
+        }
+    }
+
+    int col = cursorX_ - viewX_;
+    int row = cursorY_ - viewY_;
+    if (col >= col0 && col <= col1 && row >= row0 && row <= row1) {
+        lv_draw_rect_dsc_t cursor;
+        lv_draw_rect_dsc_init(&cursor);
+        cursor.bg_opa = LV_OPA_TRANSP;
+        cursor.border_width = size >= 24 ? 3 : 2;
+        cursor.border_color = lv_color_make(0, 0, 255);
+        cursor.radius = 2;
+        lv_area_t area = {originX + col * size, originY + row * size,
+                          originX + col * size + size - 2, originY + row * size + size - 2};
+        lv_draw_rect(layer, &cursor, &area);
+    }
+}
 
+void Minesweeper::drawCallback(lv_event_t* e) {
+    auto* game = static_cast<Minesweeper*>(lv_event_get_user_data(e));
+    game->drawBoard(lv_event_get_layer(e));
+}
 
 void Minesweeper::resetGame() {
     flagCount_ = 0;
     revealedCount_ = 0;
     totalFlags_ = 0;
     firstClick_ = true;
+    showMines_ = false;
+    won_ = false;
     cursorX_ = 0;
     cursorY_ = 0;
     
-    for (int y = 0; y < GRID_HEIGHT; y++) {
-        for (int x = 0; x < GRID_WIDTH; x++) {
-            Cell& cell = grid_[y][x];
-            cell.hasMine = false;
-            cell.adjacentMines = 0;
-            cell.state = HIDDEN;
-            lv_label_set_text(cell.label, "");
-            lv_obj_set_style_bg_color(cell.obj, lv_color_make(200, 200, 200), 0);
-        }
+    for (Cell& cell : grid_) {
+        cell.hasMine = false;
+        cell.adjacentMines = 0;
+        cell.state = HIDDEN;
     }
+    zeros_.clear();
+    open_.clear();
+    pending_.clear();
+    viewX_ = viewY_ = 0;
+    lv_obj_invalidate(gameBoard_);
     
     updateDisplay();
 }
 
 void Minesweeper::placeMines() {
     std::vector<std::pair<int, int>> positions;
-    for (int y = 0; y < GRID_HEIGHT; y++) {
-        for (int x = 0; x < GRID_WIDTH; x++) {
+    positions.reserve(grid_.size());
+    for (int y = 0; y < config_.gridHeight; y++) {
+        for (int x = 0; x < config_.gridWidth; x++) {
             if (x != cursorX_ || y != cursorY_) {
                 positions.push_back({x, y});
             }
@@ -296,17 +579,17 @@ void Minesweeper::placeMines() {
     
     std::shuffle(positions.begin(), positions.end(), gen_);
     
-    for (int i = 0; i < MINE_COUNT && i < positions.size(); i++) {
+    for (int i = 0; i < config_.mines && i < static_cast<int>(positions.size()); i++) {
         int x = positions[i].first;
         int y = positions[i].second;
-        grid_[y][x].hasMine = true;
+        cellAt(x, y).hasMine = true;
     }
 }
 
 void Minesweeper::calculateNumbers() {
-    for (int y = 0; y < GRID_HEIGHT; y++) {
-        for (int x = 0; x < GRID_WIDTH; x++) {
-            if (!grid_[y][x].hasMine) {
+    for (int y = 0; y < config_.gridHeight; y++) {
+        for (int x = 0; x < config_.gridWidth; x++) {
+            if (!cellAt(x, y).hasMine) {
                 int count = 0;
                 
                 for (int dy = -1; dy <= 1; dy++) {
@@ -316,114 +599,46 @@ void Minesweeper::calculateNumbers() {
                         int nx = x + dx;
                         int ny = y + dy;
                         
-                        if (nx >= 0 && nx < GRID_WIDTH && 
-                            ny >= 0 && ny < GRID_HEIGHT &&
-                            grid_[ny][nx].hasMine) {
+                        if (nx >= 0 && nx < config_.gridWidth && 
+                            ny >= 0 && ny < config_.gridHeight &&
+                            cellAt(nx, ny).hasMine) {
                             count++;
                         }
                     }
                 }
                 
-                grid_[y][x].adjacentMines = count;
-            }
-        }
-    }
-}
-
-void Minesweeper::revealCell(int x, int y) {
-    if (x < 0 || x >= GRID_WIDTH || y < 0 || y >= GRID_HEIGHT) return;
-
-    std::queue<std::pair<int, int>> toReveal;
-    toReveal.push({x, y});
-
-    while (!toReveal.empty()) {
-        auto [cx, cy] = toReveal.front();
-        toReveal.pop();
-
-        if (cx < 0 || cx >= GRID_WIDTH || cy < 0 || cy >= GRID_HEIGHT)
-            continue;
-
-        Cell& cell = grid_[cy][cx];
-
-        if (cell.state == REVEALED)
-            continue;
-
-        if (cell.state == FLAGGED) {
-            cell.state = HIDDEN;
-            totalFlags_--;
-            lv_label_set_text(cell.label, "");
-            lv_obj_set_style_bg_color(cell.obj, lv_color_make(180, 180, 180), 0);
-            updateDisplay();
-        }
-
-        if (cell.state != HIDDEN)
-            continue;
-
-        cell.state = REVEALED;
-        revealedCount_++;
-
-        //lv_label_set_text(cell.label, "");
-        //lv_obj_set_style_text_color(cell.label, lv_color_make(0, 0, 0), 0);
-        //lv_obj_set_style_bg_color(cell.obj, lv_color_make(140, 140, 140), 0);
-
-        if (cell.hasMine) {
-            lv_label_set_text(cell.label, "*");
-            lv_obj_set_style_bg_color(cell.obj, lv_color_make(0, 0, 255), 0);
-            lv_obj_set_style_text_color(cell.label, lv_color_make(255, 255, 255), 0);
-            revealAllMines();
-            gameOver(false);
-            return;
-        }
-
-        if (cell.adjacentMines > 0) {
-            char text[12];
-            snprintf(text, sizeof(text), "%d", cell.adjacentMines);
-            lv_label_set_text(cell.label, text);
-            lv_obj_set_style_text_color(cell.label, getNumberColor(cell.adjacentMines), 0);
-        } else {
-            for (int dy = -1; dy <= 1; dy++) {
-                for (int dx = -1; dx <= 1; dx++) {
-                    if (dx == 0 && dy == 0) continue;
-                    toReveal.push({cx + dx, cy + dy});
+                cellAt(x, y).adjacentMines = count;
+                if (count == 0) {
+                    zeros_.set(x, y);
                 }
             }
         }
     }
-
-    checkWin();
 }
 
-
 void Minesweeper::toggleFlag(int x, int y) {
-    Cell& cell = grid_[y][x];
+    Cell& cell = cellAt(x, y);
     
     if (cell.state == REVEALED) return;
     
     if (cell.state == HIDDEN) {
         cell.state = FLAGGED;
         totalFlags_++;
-        lv_label_set_text(cell.label, "F");
-        lv_obj_set_style_text_color(cell.label, lv_color_make(0, 0, 255), 0);
-        lv_obj_set_style_bg_color(cell.obj, lv_color_make(255, 200, 200), 0);
     } else if (cell.state == FLAGGED) {
         cell.state = HIDDEN;
         totalFlags_--;
-        lv_label_set_text(cell.label, "");
-        lv_obj_set_style_bg_color(cell.obj, lv_color_make(180, 180, 180), 0);
     }
+    invalidateCell(x, y);
     
     updateDisplay();
     
-    if (totalFlags_ == MINE_COUNT) {
+    if (totalFlags_ == config_.mines) {
         bool allCorrect = true;
-        for (int y = 0; y < GRID_HEIGHT; y++) {
-            for (int x = 0; x < GRID_WIDTH; x++) {
-                if (grid_[y][x].state == FLAGGED && !grid_[y][x].hasMine) {
-                    allCorrect = false;
-                    break;
-                }
+        for (const Cell& c : grid_) {
+            if (c.state == FLAGGED && !c.hasMine) {
+                allCorrect = false;
+                break;
             }
-            if (!allCorrect) break;
         }
         if (allCorrect) {
             checkWin();
@@ -431,44 +646,31 @@ void Minesweeper::toggleFlag(int x, int y) {
     }
 }
 
+// Unflagged mines and wrong flags are drawn differently from now on
 void Minesweeper::revealAllMines() {
-    for (int y = 0; y < GRID_HEIGHT; y++) {
-        for (int x = 0; x < GRID_WIDTH; x++) {
-            Cell& cell = grid_[y][x];
-            if (cell.hasMine && cell.state != FLAGGED) {
-                lv_label_set_text(cell.label, "*");
-                lv_obj_set_style_bg_color(cell.obj, lv_color_make(0, 0, 200), 0);
-                lv_obj_set_style_text_color(cell.label, lv_color_make(255, 255, 255), 0);
-            } else if (!cell.hasMine && cell.state == FLAGGED) {
-                lv_label_set_text(cell.label, "X");
-                lv_obj_set_style_bg_color(cell.obj, lv_color_make(255, 200, 200), 0);
-            }
-        }
-    }
+    showMines_ = true;
+    lv_obj_invalidate(gameBoard_);
 }
 
 void Minesweeper::checkWin() {
-    int safeCells = GRID_WIDTH * GRID_HEIGHT - MINE_COUNT;
+    int safeCells = config_.gridWidth * config_.gridHeight - config_.mines;
     
     if (revealedCount_ == safeCells) {
-        for (int y = 0; y < GRID_HEIGHT; y++) {
-            for (int x = 0; x < GRID_WIDTH; x++) {
-                Cell& cell = grid_[y][x];
-                if (cell.hasMine) {
-                    cell.state = FLAGGED;
-                    lv_label_set_text(cell.label, "F");
-                    lv_obj_set_style_text_color(cell.label, lv_color_make(0, 255, 0), 0);
-                    lv_obj_set_style_bg_color(cell.obj, lv_color_make(200, 255, 200), 0);
-                }
+        finishReveal();
+        for (Cell& cell : grid_) {
+            if (cell.hasMine) {
+                cell.state = FLAGGED;
             }
         }
+        won_ = true;
+        lv_obj_invalidate(gameBoard_);
         gameOver(true);
     }
 }
 
 void Minesweeper::updateDisplay() {
     char mineText[50];
-    snprintf(mineText, sizeof(mineText), "Mines: %d | Flags: %d", MINE_COUNT - totalFlags_, totalFlags_);
+    snprintf(mineText, sizeof(mineText), "Mines: %d | Flags: %d", config_.mines - totalFlags_, totalFlags_);
     lv_label_set_text(mineCountLabel_, mineText);
 }
 
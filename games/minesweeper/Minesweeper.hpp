@@ -1,73 +1,146 @@
 #pragma once
 
 #include "Game.hpp"
+#include "CellBits.hpp"
 #include "lvgl.h"
 #include <string>
 #include <vector>
 #include <random>
-#include <queue>
 
+// Board size, mine count and pixel size of one Minesweeper variant
+struct MinesweeperConfig {
+    const char* name;
+    int gridWidth;          // up to CellBits::MAX_WIDTH
+    int gridHeight;
+    int mines;
+    int cellSize;
+};
+
+// Cells are one byte each, no LVGL objects. The board is a single object whose
+// draw callback blits pre-rendered tile images (hidden, flag, mine, 0-8 ...) for
+// the visible cells, a change invalidates just that cell. Boards larger than the
+// screen are shown through a viewport that pans with the cursor.
 class Minesweeper : public Game {
 public:
-    Minesweeper();
+    static const MinesweeperConfig BEGINNER;
+    static const MinesweeperConfig EXPERT;
+    static const MinesweeperConfig XL;
+
+    explicit Minesweeper(const MinesweeperConfig& config = BEGINNER);
     ~Minesweeper() override;
 
     void run() override;
     void update() override;
     void stop() override;
     void handleKey(uint32_t key) override;
-    std::string name() const override { return "Minesweeper"; }
-    void processRevealStep();
+    std::string name() const override { return config_.name; }
+    bool isEventDriven() const override { return true; }
 
 private:
-    static const int GRID_WIDTH = 9;
-    static const int GRID_HEIGHT = 9;
-    static const int CELL_SIZE = 30;
-    static const int MINE_COUNT = 10;
-    
-    enum CellState {
+    static const int BOARD_TOP = 70;        // below the status lines
+    static const int BOARD_BOTTOM = 400;    // above the instructions
+    static const int BOARD_BORDER = 2;
+    static const int PAN_MARGIN = 2;        // cells kept between the cursor and the viewport edge
+    static const uint32_t RING_PERIOD_MS = 16;  // one reveal ring per frame
+
+    enum CellState : uint8_t {
         HIDDEN,
         REVEALED,
         FLAGGED
     };
-    
+
     struct Cell {
-        lv_obj_t* obj;
-        lv_obj_t* label;
         bool hasMine;
-        int adjacentMines;
+        uint8_t adjacentMines;
         CellState state;
     };
-    
+
+    // Pre-rendered images, OPEN_0 + n is a revealed cell with n adjacent mines
+    enum Tile {
+        TILE_HIDDEN,
+        TILE_FLAG,
+        TILE_FLAG_WIN,
+        TILE_FLAG_WRONG,
+        TILE_MINE,
+        TILE_MINE_HIT,
+        TILE_OPEN_0,
+        TILE_COUNT = TILE_OPEN_0 + 9
+    };
+
     void createGameScreen();
+    bool createTiles();
     void resetGame();
     void placeMines();
     void calculateNumbers();
-    void revealCell(int x, int y);
     void toggleFlag(int x, int y);
     void revealAllMines();
     void checkWin();
     void updateDisplay();
     void gameOver(bool win);
     void startRevealFrom(int x, int y);
+    void revealStep();
+    void finishReveal();
+    bool startGeneration(int x, int y);
+    void generationStep();
     lv_color_t getNumberColor(int number);
-    
+
+    Cell& cellAt(int x, int y) { return grid_[y * config_.gridWidth + x]; }
+    Tile tileFor(int x, int y);
+    void invalidateCell(int x, int y);
+    void panToCursor();
+    void drawBoard(lv_layer_t* layer);
+
+    static void drawCallback(lv_event_t* e);
+    static void revealTimerCallback(lv_timer_t* timer);
+
+    const MinesweeperConfig& config_;
+
     lv_obj_t* screen_;
     lv_obj_t* gameBoard_;
     lv_obj_t* statusLabel_;
     lv_obj_t* mineCountLabel_;
-    lv_obj_t* cursor_;
-    
-    Cell grid_[GRID_HEIGHT][GRID_WIDTH];
 
-    std::queue<std::pair<int, int>> revealQueue_;
+    // Tile images share one strip in PSRAM
+    lv_draw_buf_t tileBuf_ = {};
+    void* tileData_ = nullptr;
+    lv_image_dsc_t tiles_[TILE_COUNT] = {};
+
+    // Visible part of the board, in cells
+    int viewX_ = 0;
+    int viewY_ = 0;
+    int viewCols_ = 0;
+    int viewRows_ = 0;
+
+    std::vector<Cell> grid_;
+
+    // Reveals are computed at once as a wavefront over bitsets, ring by ring.
+    // Cells are REVEALED right away, pending_ keeps them drawn hidden until
+    // their ring is shown. Each cell is in at most one ring.
+    CellBits zeros_;            // safe cells without adjacent mines, the wave spreads from these
+    CellBits open_;             // REVEALED cells
+    CellBits frontier_;
+    CellBits next_;
+    CellBits pending_;
+    std::vector<uint16_t> ringCells_;   // y * width + x, ring after ring
+    std::vector<uint16_t> ringStarts_;  // index of the first cell of every ring
+    size_t ringIndex_ = 0;
     lv_timer_t* revealTimer_ = nullptr;
+
+    // Mines are placed after the first click by MineGenerator on the other core,
+    // revealTimer_ polls for the board meanwhile
+    CellBits mines_;
+    bool generating_ = false;
+    int startX_ = 0;
+    int startY_ = 0;
+
     int cursorX_;
     int cursorY_;
     int flagCount_;
     int revealedCount_;
     bool gameRunning_;
     bool firstClick_;
+    bool showMines_ = false;    // after a loss
+    bool won_ = false;
     int totalFlags_;
     bool stopped_ = false;
     std::random_device rd_;
@@ -76,4 +149,4 @@ private:
 
 struct RegisterMinesweeper {
     RegisterMinesweeper();
-} inline g_registerMinesweeper;
\ No newline at end of file
+} inline g_registerMinesweeper;
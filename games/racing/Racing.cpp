@@ -2,6 +2,8 @@
 #include "GameRegistry.hpp"
 #include "core/lv_obj_pos.h"
 #include "lvgl_helper.hpp"
+#include "DeferredDeleter.hpp"
+#include "OverlayService.hpp"
 
 #include <cstdio>
 #include <algorithm>
@@ -34,6 +36,7 @@ Racing::Racing()
     player_.obj = nullptr;
     player_.leftWheelsObj = nullptr;
     player_.rightWheelsObj = nullptr;
+    obstacles_.reserve(maxObstaclesOnScreen_);
 }
 
 Racing::~Racing() {
@@ -100,7 +103,7 @@ void Racing::stop() {
     }
     
     if (screen_ && lv_obj_is_valid(screen_)) {
-        lv_obj_del(screen_);
+        DeferredDeleter::instance().enqueue(screen_);
         screen_ = nullptr;
     }
     
@@ -321,23 +324,26 @@ void Racing::updateObstacles() {
         }
     }
 
-    std::vector<size_t> toDeleteIndices;
-    for (size_t i = 0; i < obstacles_.size(); ++i) {
-        if (obstacles_[i].y > 480) {
-            toDeleteIndices.push_back(i);
-            score_ += 10;
-            updateScore();
+    // Compact in place, no per-tick temporaries. The vector keeps its reserved
+    // capacity, so dropping passed obstacles never allocates.
+    size_t write = 0;
+    int passed = 0;
+    for (size_t read = 0; read < obstacles_.size(); read++) {
+        if (obstacles_[read].y > 480) {
+            cleanupObstacle(obstacles_[read]);
+            passed++;
+            continue;
         }
+        if (write != read) {
+            obstacles_[write] = obstacles_[read];
+        }
+        write++;
     }
+    obstacles_.resize(write);
 
-    for (size_t i : toDeleteIndices) {
-        cleanupObstacle(obstacles_[i]);
-    }
-
-    for (auto it = obstacles_.rbegin(); it != obstacles_.rend(); ++it) {
-        if (it->y > 480) {
-            obstacles_.erase(std::next(it).base());
-        }
+    if (passed > 0) {
+        score_ += 10 * passed;
+        updateScore();
     }
 
     bool canSpawn = true;
@@ -370,21 +376,23 @@ void Racing::updateObstacles() {
 void Racing::spawnObstacle() {
     if (!road_ || !lv_obj_is_valid(road_)) return;
     
-    std::vector<int> occupiedLanes;
+    uint32_t occupiedLanes = 0;
+    int occupiedCount = 0;
     for (const auto& obstacle : obstacles_) {
-        if (obstacle.y < 200) {
-            occupiedLanes.push_back(obstacle.lane);
+        if (obstacle.y < 200 && !(occupiedLanes & (1u << obstacle.lane))) {
+            occupiedLanes |= 1u << obstacle.lane;
+            occupiedCount++;
         }
     }
     
-    if (occupiedLanes.size() >= laneCount_ - 1) {
+    if (occupiedCount >= laneCount_ - 1) {
         return;
     }
     
     int newLane;
     do {
         newLane = laneDist_(gen_);
-    } while (std::find(occupiedLanes.begin(), occupiedLanes.end(), newLane) != occupiedLanes.end());
+    } while (occupiedLanes & (1u << newLane));
     
     Obstacle obstacle;
     obstacle.lane = newLane;
@@ -435,11 +443,7 @@ void Racing::gameOver() {
     
     if (!screen_ || !lv_obj_is_valid(screen_)) return;
     
-    lv_obj_t* overlayBg = lv_obj_create(screen_);
-    lv_obj_set_size(overlayBg, 320, 480);
-    lv_obj_set_pos(overlayBg, 0, 0);
-    lv_obj_set_style_bg_color(overlayBg, lv_color_make(0, 0, 0), 0);
-    lv_obj_set_style_bg_opa(overlayBg, 220, 0);
+    lv_obj_t* overlayBg = OverlayService::instance().show(screen_, 220);
     
     lv_obj_t* gameOverLabel = lv_label_create(overlayBg);
     lv_label_set_text(gameOverLabel, "CRASH!");
@@ -1,5 +1,6 @@
 #include "SimpleCatcher.hpp"
 #include "GameRegistry.hpp"
+#include "DeferredDeleter.hpp"
 #include <cstdio>
 #include <algorithm>
 #include "esp_log.h"
@@ -69,7 +70,7 @@ void SimpleCatcher::stop() {
     }
 
     if (screen_) {
-        lv_obj_del(screen_);
+        DeferredDeleter::instance().enqueue(screen_);
         screen_ = nullptr;
     }
 }
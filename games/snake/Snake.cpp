@@ -1,19 +1,35 @@
 #include "Snake.hpp"
 #include "GameRegistry.hpp"
 #include "lvgl_helper.hpp"
+#include "DeferredDeleter.hpp"
+#include "app_config.h"
+#include "esp_heap_caps.h"
 #include "esp_log.h"
 #include <cstdio>
 #include <algorithm>
 #include <cstring>
 
+static const char *TAG = "Snake";
+
+static const lv_color_format_t BOARD_FORMAT = LV_COLOR_FORMAT_RGB565;
+
+const SnakeConfig Snake::CLASSIC = {"Snake", 15, 15, 18, 300, 50, 50};
+// Full display width at 4 px per cell, the same pace in cells per second grows with the board
+const SnakeConfig Snake::XL = {"Snake XL", DISP_WIDTH / 4, (DISP_HEIGHT - 40) / 4, 4, 80, 20, 10};
+
 RegisterSnake::RegisterSnake() {
-    GameRegistry::instance().registerGame("Snake", []() {
-        return std::make_unique<Snake>();
+    GameRegistry::instance().registerGame(Snake::CLASSIC.name, []() {
+        return std::make_unique<Snake>(Snake::CLASSIC);
+    });
+    GameRegistry::instance().registerGame(Snake::XL.name, []() {
+        return std::make_unique<Snake>(Snake::XL);
     });
 }
 
-Snake::Snake()
-    : screen_(nullptr),
+Snake::Snake(const SnakeConfig& config)
+    : config_(config),
+      gap_(config.cellSize >= 8 ? 1 : 0),
+      screen_(nullptr),
       scoreLabel_(nullptr),
       updateTimer_(nullptr),
       currentDirection_(DIR_RIGHT),
@@ -23,12 +39,11 @@ Snake::Snake()
       foodEaten_(0),
       gameRunning_(false),
       stopped_(false),
-      moveSpeed_(INITIAL_SPEED),
-      gen_(rd_()),
-      xDist_(0, GRID_WIDTH - 1),
-      yDist_(0, GRID_HEIGHT - 1)
+      moveSpeed_(config.initialSpeed),
+      gen_(rd_())
 {
-    memset(cells_, 0, sizeof(cells_));
+    grid_.init(config.gridWidth, config.gridHeight);
+    food_ = 0;
 }
 
 Snake::~Snake() {
@@ -43,13 +58,15 @@ void Snake::run() {
     updateTimer_ = lv_timer_create(gameUpdateTimerCallback, moveSpeed_, this);
 }
 
+// Event-driven: called after keys, which only set the next direction
 void Snake::update() {
+}
+
+void Snake::tick() {
     if (!gameRunning_) return;
     
     currentDirection_ = nextDirection_;
     moveSnake();
-    checkCollisions();
-    updateDisplay();
 }
 
 void Snake::stop() {
@@ -63,8 +80,18 @@ void Snake::stop() {
         updateTimer_ = nullptr;
     }
     
+    // The canvas goes before its buffer, the rest of the screen is deleted later
+    if (canvas_) {
+        lv_obj_del(canvas_);
+        canvas_ = nullptr;
+    }
+    if (boardData_) {
+        heap_caps_free(boardData_);
+        boardData_ = nullptr;
+    }
+    
     if (screen_) {
-        lv_obj_del(screen_);
+        DeferredDeleter::instance().enqueue(screen_);
         screen_ = nullptr;
     }
 }
@@ -118,111 +145,137 @@ void Snake::createGameScreen() {
     lv_obj_set_style_text_color(levelLabel, lv_color_make(255, 255, 255), 0);
     lv_obj_set_style_text_font(levelLabel, &lv_font_montserrat_20, 0);
     
-    // Board container
-    lv_obj_t* boardContainer = createCleanObject(screen_);
-    lv_obj_set_size(boardContainer, GRID_WIDTH * CELL_SIZE + 2, GRID_HEIGHT * CELL_SIZE + 2);
-    lv_obj_align(boardContainer, LV_ALIGN_CENTER, 0, 10);
-    lv_obj_set_style_bg_color(boardContainer, lv_color_make(32, 32, 32), 0);
-    lv_obj_set_style_border_width(boardContainer, 1, 0);
-    
-    // Create cell template
-    lv_obj_t* cellTemplate = createCleanObject(nullptr);
-    lv_obj_remove_style_all(cellTemplate);
-    lv_obj_set_size(cellTemplate, CELL_SIZE - 1, CELL_SIZE - 1);
-    lv_obj_clear_flag(cellTemplate, LV_OBJ_FLAG_SCROLLABLE);
-    lv_obj_clear_flag(cellTemplate, LV_OBJ_FLAG_CLICKABLE);
-    lv_obj_set_style_radius(cellTemplate, 2, LV_PART_MAIN);
-    lv_obj_set_style_border_width(cellTemplate, 0, LV_PART_MAIN);
-    lv_obj_set_style_pad_all(cellTemplate, 0, LV_PART_MAIN);
-    lv_obj_set_style_bg_opa(cellTemplate, LV_OPA_COVER, LV_PART_MAIN);
-    lv_obj_set_style_bg_color(cellTemplate, lv_color_make(40, 40, 40), LV_PART_MAIN);
-    
-    // Create cells
-    for (int y = 0; y < GRID_HEIGHT; y++) {
-        for (int x = 0; x < GRID_WIDTH; x++) {
-            cells_[y][x] = lv_obj_create(boardContainer);
-            lv_obj_remove_style_all(cells_[y][x]);
-            lv_obj_set_size(cells_[y][x], CELL_SIZE - 1, CELL_SIZE - 1);
-            lv_obj_set_pos(cells_[y][x], x * CELL_SIZE + 1, y * CELL_SIZE + 1);
-            lv_obj_clear_flag(cells_[y][x], LV_OBJ_FLAG_SCROLLABLE);
-            lv_obj_clear_flag(cells_[y][x], LV_OBJ_FLAG_CLICKABLE);
-            lv_obj_set_style_radius(cells_[y][x], 2, LV_PART_MAIN);
-            lv_obj_set_style_border_width(cells_[y][x], 0, LV_PART_MAIN);
-            lv_obj_set_style_pad_all(cells_[y][x], 0, LV_PART_MAIN);
-            lv_obj_set_style_bg_opa(cells_[y][x], LV_OPA_COVER, LV_PART_MAIN);
-            lv_obj_set_style_bg_color(cells_[y][x], lv_color_make(40, 40, 40), LV_PART_MAIN);
-        }
+    if (!createBoard()) {
+        ESP_LOGE(TAG, "No PSRAM for the %dx%d board", config_.gridWidth, config_.gridHeight);
     }
     
-    lv_obj_del(cellTemplate);
-    
-    lv_obj_t* controlsLabel = lv_label_create(screen_);
-    applyCleanStyle(controlsLabel);
-    lv_label_set_text(controlsLabel, "<- -> ^ v Move\nESC Exit");
-    lv_obj_align(controlsLabel, LV_ALIGN_BOTTOM_MID, 0, -10);
-    lv_obj_set_style_text_color(controlsLabel, lv_color_make(200, 200, 200), 0);
-    lv_obj_set_style_text_align(controlsLabel, LV_TEXT_ALIGN_CENTER, 0);
+    // Large boards leave no room for the help text
+    int boardHeight = config_.gridHeight * config_.cellSize + gap_;
+    if (DISP_HEIGHT - BOARD_TOP - boardHeight >= 100) {
+        lv_obj_t* controlsLabel = lv_label_create(screen_);
+        applyCleanStyle(controlsLabel);
+        lv_label_set_text(controlsLabel, "<- -> ^ v Move\nESC Exit");
+        lv_obj_align(controlsLabel, LV_ALIGN_BOTTOM_MID, 0, -10);
+        lv_obj_set_style_text_color(controlsLabel, lv_color_make(200, 200, 200), 0);
+        lv_obj_set_style_text_align(controlsLabel, LV_TEXT_ALIGN_CENTER, 0);
+    }
     
     lv_scr_load(screen_);
     
     ESP_LOGI("MEM", "[Snake After] Free internal: %d", heap_caps_get_free_size(MALLOC_CAP_INTERNAL));
 }
 
+// Grid lines in the background color, every cell empty
+bool Snake::createBoard() {
+    int width = config_.gridWidth * config_.cellSize + gap_;
+    int height = config_.gridHeight * config_.cellSize + gap_;
+    uint32_t stride = lv_draw_buf_width_to_stride(width, BOARD_FORMAT);
+    uint32_t size = stride * height;
+
+    boardData_ = heap_caps_aligned_alloc(LV_DRAW_BUF_ALIGN, size, MALLOC_CAP_SPIRAM);
+    if (!boardData_) {
+        return false;
+    }
+    lv_draw_buf_init(&boardBuf_, width, height, BOARD_FORMAT, stride, boardData_, size);
+
+    palette_[COLOR_EMPTY] = lv_color_to_u16(lv_color_make(40, 40, 40));
+    palette_[COLOR_BODY] = lv_color_to_u16(lv_color_make(0, 200, 0));
+    palette_[COLOR_HEAD] = lv_color_to_u16(lv_color_make(0, 255, 0));
+    palette_[COLOR_FOOD] = lv_color_to_u16(lv_color_make(0, 0, 255));
+    uint16_t line = lv_color_to_u16(lv_color_make(32, 32, 32));
+
+    for (int y = 0; y < height; y++) {
+        uint16_t* px = reinterpret_cast<uint16_t*>(boardBuf_.data + y * stride);
+        bool lineRow = gap_ && y % config_.cellSize == 0;
+        for (int x = 0; x < width; x++) {
+            px[x] = (lineRow || (gap_ && x % config_.cellSize == 0)) ? line : palette_[COLOR_EMPTY];
+        }
+    }
+
+    canvas_ = lv_canvas_create(screen_);
+    lv_canvas_set_draw_buf(canvas_, &boardBuf_);
+    // Centered a little low, a board that fills the screen starts below the score
+    int top = std::max(BOARD_TOP, (DISP_HEIGHT - height) / 2 + 10);
+    lv_obj_set_pos(canvas_, (DISP_WIDTH - width) / 2, top);
+    // Coordinates are needed for the first partial invalidations
+    lv_obj_update_layout(canvas_);
+    return true;
+}
+
 void Snake::resetGame() {
     score_ = 0;
     level_ = 1;
     foodEaten_ = 0;
-    moveSpeed_ = INITIAL_SPEED;
+    moveSpeed_ = config_.initialSpeed;
     currentDirection_ = DIR_RIGHT;
     nextDirection_ = DIR_RIGHT;
     
-    snake_.clear();
+    grid_.clear();
     
-    // Initialize snake in the center
-    int startX = GRID_WIDTH / 2;
-    int startY = GRID_HEIGHT / 2;
+    // Initialize snake in the center, tail first
+    int startX = config_.gridWidth / 2;
+    int startY = config_.gridHeight / 2;
     
-    for (int i = 0; i < INITIAL_LENGTH; i++) {
-        Position pos;
-        pos.x = startX - i;
-        pos.y = startY;
-        snake_.push_back(pos);
+    for (int i = INITIAL_LENGTH - 1; i >= 0; i--) {
+        SnakeGrid::Cell cell = grid_.cellAt(startX - i, startY);
+        grid_.pushHead(cell);
+        paintCell(cell, i == 0 ? COLOR_HEAD : COLOR_BODY);
     }
     
     spawnFood();
     updateScore();
-    updateDisplay();
 }
 
 void Snake::moveSnake() {
-    if (snake_.empty()) return;
+    if (grid_.length() == 0) return;
     
-    Position newHead = snake_.front();
+    SnakeGrid::Cell oldHead = grid_.head();
+    int x = grid_.x(oldHead);
+    int y = grid_.y(oldHead);
     
     switch (currentDirection_) {
         case DIR_UP:
-            newHead.y--;
+            y--;
             break;
         case DIR_DOWN:
-            newHead.y++;
+            y++;
             break;
         case DIR_LEFT:
-            newHead.x--;
+            x--;
             break;
         case DIR_RIGHT:
-            newHead.x++;
+            x++;
             break;
     }
     
-    snake_.push_front(newHead);
+    if (x < 0 || x >= config_.gridWidth || y < 0 || y >= config_.gridHeight) {
+        gameOver();
+        return;
+    }
+    
+    SnakeGrid::Cell newHead = grid_.cellAt(x, y);
+    bool eating = newHead == food_;
+    
+    // The tail moves away in the same tick unless the snake grows
+    if (grid_.occupied(newHead) && (eating || newHead != grid_.tail())) {
+        gameOver();
+        return;
+    }
+    
+    if (!eating) {
+        paintCell(grid_.popTail(), COLOR_EMPTY);
+    }
+    grid_.pushHead(newHead);
+    paintCell(oldHead, COLOR_BODY);
+    paintCell(newHead, COLOR_HEAD);
     
-    if (newHead.x == food_.x && newHead.y == food_.y) {
+    if (eating) {
         score_ += 10;
         foodEaten_++;
         
         if (foodEaten_ % 5 == 0) {
             level_++;
-            moveSpeed_ = std::max(50, moveSpeed_ - 50);
+            moveSpeed_ = std::max(config_.minSpeed, moveSpeed_ - config_.speedStep);
             if (updateTimer_) {
                 lv_timer_set_period(updateTimer_, moveSpeed_);
             }
@@ -230,73 +283,44 @@ void Snake::moveSnake() {
         
         updateScore();
         spawnFood();
-    } else {
-        snake_.pop_back();
     }
 }
 
+// Uniform over the free cells, no retries however long the snake is
 void Snake::spawnFood() {
-    bool validPosition = false;
-    
-    while (!validPosition) {
-        food_.x = xDist_(gen_);
-        food_.y = yDist_(gen_);
-        
-        validPosition = true;
-        for (const auto& segment : snake_) {
-            if (segment.x == food_.x && segment.y == food_.y) {
-                validPosition = false;
-                break;
-            }
-        }
-    }
-}
-
-void Snake::checkCollisions() {
-    if (snake_.empty()) return;
-    
-    Position head = snake_.front();
-    
-    if (head.x < 0 || head.x >= GRID_WIDTH || 
-        head.y < 0 || head.y >= GRID_HEIGHT) {
+    if (grid_.freeCount() == 0) {
         gameOver();
         return;
     }
     
-    auto it = snake_.begin();
-    ++it;
-    for (; it != snake_.end(); ++it) {
-        if (it->x == head.x && it->y == head.y) {
-            gameOver();
-            return;
-        }
-    }
+    std::uniform_int_distribution<int> dist(0, grid_.freeCount() - 1);
+    food_ = grid_.freeCell(dist(gen_));
+    paintCell(food_, COLOR_FOOD);
 }
 
-void Snake::updateDisplay() {
-    // Clear all cells
-    for (int y = 0; y < GRID_HEIGHT; y++) {
-        for (int x = 0; x < GRID_WIDTH; x++) {
-            lv_obj_set_style_bg_color(cells_[y][x], lv_color_make(40, 40, 40), 0);
-        }
-    }
-    
-    // Draw snake
-    bool isHead = true;
-    for (const auto& segment : snake_) {
-        if (segment.x >= 0 && segment.x < GRID_WIDTH &&
-            segment.y >= 0 && segment.y < GRID_HEIGHT) {
-            lv_color_t color = isHead ? lv_color_make(0, 255, 0) : lv_color_make(0, 200, 0);
-            lv_obj_set_style_bg_color(cells_[segment.y][segment.x], color, 0);
+// Writes the cell's pixels into the canvas buffer and invalidates just that area
+void Snake::paintCell(SnakeGrid::Cell cell, CellColor color) {
+    if (!canvas_) return;
+
+    int size = config_.cellSize - gap_;
+    int left = grid_.x(cell) * config_.cellSize + gap_;
+    int top = grid_.y(cell) * config_.cellSize + gap_;
+    uint16_t value = palette_[color];
+
+    for (int y = top; y < top + size; y++) {
+        uint16_t* px = reinterpret_cast<uint16_t*>(boardBuf_.data + y * boardBuf_.header.stride) + left;
+        for (int x = 0; x < size; x++) {
+            px[x] = value;
         }
-        isHead = false;
-    }
-    
-    // Draw food
-    if (food_.x >= 0 && food_.x < GRID_WIDTH &&
-        food_.y >= 0 && food_.y < GRID_HEIGHT) {
-        lv_obj_set_style_bg_color(cells_[food_.y][food_.x], lv_color_make(0, 0, 255), 0);
     }
+
+    lv_area_t coords;
+    lv_obj_get_coords(canvas_, &coords);
+    lv_area_t area = {
+        static_cast<int32_t>(coords.x1 + left), static_cast<int32_t>(coords.y1 + top),
+        static_cast<int32_t>(coords.x1 + left + size - 1), static_cast<int32_t>(coords.y1 + top + size - 1)
+    };
+    lv_obj_invalidate_area(canvas_, &area);
 }
 
 void Snake::updateScore() {
@@ -328,6 +352,6 @@ void Snake::gameOver() {
 void Snake::gameUpdateTimerCallback(lv_timer_t* timer) {
     Snake* game = static_cast<Snake*>(lv_timer_get_user_data(timer));
     if (game && game->gameRunning_) {
-        game->update();
+        game->tick();
     }
 }
\ No newline at end of file
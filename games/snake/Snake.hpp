@@ -1,79 +1,101 @@
 #pragma once
 
 #include "Game.hpp"
+#include "SnakeGrid.hpp"
 #include "lvgl.h"
 #include <string>
-#include <deque>
 #include <random>
 
+// Grid size, cell size in pixels and pace of one Snake variant
+struct SnakeConfig {
+    const char* name;
+    int gridWidth;
+    int gridHeight;
+    int cellSize;
+    int initialSpeed;   // ms per move
+    int minSpeed;
+    int speedStep;      // faster by this much every 5 food
+};
+
+// The board is one RGB565 canvas in PSRAM instead of an object per cell, cells
+// are written straight into its buffer and only their areas are invalidated.
+// Memory follows the grid and pixel size, a tick costs the few changed cells.
 class Snake : public Game {
 public:
-    Snake();
+    static const SnakeConfig CLASSIC;
+    static const SnakeConfig XL;
+
+    explicit Snake(const SnakeConfig& config = CLASSIC);
     ~Snake() override;
 
     void run() override;
     void update() override;
     void stop() override;
     void handleKey(uint32_t key) override;
-    std::string name() const override { return "Snake"; }
+    std::string name() const override { return config_.name; }
+
+    // Moves come from the game's own timer only
+    bool isEventDriven() const override { return true; }
 
 private:
-    static const int GRID_WIDTH = 15;
-    static const int GRID_HEIGHT = 15;
-    static const int CELL_SIZE = 18;
     static const int INITIAL_LENGTH = 3;
-    static const int INITIAL_SPEED = 300;
-    
+    static const int BOARD_TOP = 40;   // below the score line
+
     enum Direction {
         DIR_UP,
         DIR_DOWN,
         DIR_LEFT,
         DIR_RIGHT
     };
-    
-    struct Position {
-        int x;
-        int y;
-        
-        bool operator==(const Position& other) const {
-            return x == other.x && y == other.y;
-        }
+
+    enum CellColor {
+        COLOR_EMPTY,
+        COLOR_BODY,
+        COLOR_HEAD,
+        COLOR_FOOD,
+        COLOR_COUNT
     };
-    
+
     void createGameScreen();
+    bool createBoard();
     void resetGame();
+    void tick();
     void moveSnake();
     void spawnFood();
-    void checkCollisions();
-    void updateDisplay();
+    void paintCell(SnakeGrid::Cell cell, CellColor color);
     void updateScore();
     void gameOver();
-    
+
     static void gameUpdateTimerCallback(lv_timer_t* timer);
-    
+
+    const SnakeConfig& config_;
+    int gap_;               // grid line width, none for small cells
+
     lv_obj_t* screen_;
     lv_obj_t* scoreLabel_;
-    lv_obj_t* cells_[GRID_HEIGHT][GRID_WIDTH];
+    lv_obj_t* canvas_ = nullptr;
+    lv_draw_buf_t boardBuf_ = {};
+    void* boardData_ = nullptr;
+    uint16_t palette_[COLOR_COUNT] = {};
     lv_timer_t* updateTimer_;
-    
-    std::deque<Position> snake_;
-    Position food_;
+
+    // A tick only repaints the new head, the old head, the vacated tail and new food
+    SnakeGrid grid_;
+    SnakeGrid::Cell food_;
     Direction currentDirection_;
     Direction nextDirection_;
-    
+
     int score_;
     int level_;
     int foodEaten_;
     bool gameRunning_;
     bool stopped_;
     int moveSpeed_;
-    
+
     std::random_device rd_;
     std::mt19937 gen_;
-    std::uniform_int_distribution<> xDist_;
-    std::uniform_int_distribution<> yDist_;
 };
 
 struct RegisterSnake {
     RegisterSnake();
-} inline g_registerSnake;
\ No newline at end of file
+} inline g_registerSnake;
@@ -0,0 +1,61 @@
+#include "SnakeGrid.hpp"
+
+void SnakeGrid::init(int width, int height) {
+    width_ = width;
+    height_ = height;
+
+    size_t cells = static_cast<size_t>(width) * height;
+    body_.assign(cells, 0);
+    bits_.assign((cells + 31) / 32, 0);
+    free_.assign(cells, 0);
+    freePos_.assign(cells, 0);
+
+    clear();
+}
+
+void SnakeGrid::clear() {
+    tail_ = 0;
+    length_ = 0;
+
+    for (auto& word : bits_) {
+        word = 0;
+    }
+
+    freeCount_ = static_cast<int>(free_.size());
+    for (int i = 0; i < freeCount_; i++) {
+        free_[i] = static_cast<Cell>(i);
+        freePos_[i] = static_cast<Cell>(i);
+    }
+}
+
+void SnakeGrid::pushHead(Cell cell) {
+    body_[(tail_ + length_) % body_.size()] = cell;
+    length_++;
+    take(cell);
+}
+
+SnakeGrid::Cell SnakeGrid::popTail() {
+    Cell cell = body_[tail_];
+    tail_ = (tail_ + 1) % body_.size();
+    length_--;
+    release(cell);
+    return cell;
+}
+
+// Swap-remove from the free list
+void SnakeGrid::take(Cell cell) {
+    bits_[cell >> 5] |= 1u << (cell & 31);
+
+    Cell pos = freePos_[cell];
+    Cell last = free_[--freeCount_];
+    free_[pos] = last;
+    freePos_[last] = pos;
+}
+
+void SnakeGrid::release(Cell cell) {
+    bits_[cell >> 5] &= ~(1u << (cell & 31));
+
+    free_[freeCount_] = cell;
+    freePos_[cell] = static_cast<Cell>(freeCount_);
+    freeCount_++;
+}
@@ -0,0 +1,54 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Snake body and board occupancy with O(1) moves, collision tests and food
+// sampling. Cells are indexed y * width + x. The body is a ring buffer of cells
+// from tail to head, occupancy is one bit per cell, and every unoccupied cell
+// sits in a free list (with its position in that list) so a random free cell is
+// one array lookup. All storage is sized once in init().
+class SnakeGrid {
+public:
+    using Cell = uint16_t;      // up to 65535 cells
+
+    void init(int width, int height);
+    void clear();
+
+    int width() const { return width_; }
+    int height() const { return height_; }
+    Cell cellAt(int x, int y) const { return static_cast<Cell>(y * width_ + x); }
+    int x(Cell cell) const { return cell % width_; }
+    int y(Cell cell) const { return cell / width_; }
+
+    int length() const { return length_; }
+    Cell head() const { return body_[(tail_ + length_ - 1) % body_.size()]; }
+    Cell tail() const { return body_[tail_]; }
+
+    bool occupied(Cell cell) const { return (bits_[cell >> 5] >> (cell & 31)) & 1; }
+
+    // The cell must be free
+    void pushHead(Cell cell);
+    // Returns the vacated cell
+    Cell popTail();
+
+    int freeCount() const { return freeCount_; }
+    Cell freeCell(int i) const { return free_[i]; }
+
+private:
+    void take(Cell cell);
+    void release(Cell cell);
+
+    int width_ = 0;
+    int height_ = 0;
+
+    std::vector<Cell> body_;
+    int tail_ = 0;
+    int length_ = 0;
+
+    std::vector<uint32_t> bits_;
+    std::vector<Cell> free_;
+    std::vector<Cell> freePos_;     // index of every free cell in free_
+    int freeCount_ = 0;
+};
@@ -2,6 +2,8 @@
 #include "GameRegistry.hpp"
 #include "esp_log.h"
 #include "lvgl_helper.hpp"
+#include "DeferredDeleter.hpp"
+#include "app_config.h"
 #include <cstdio>
 #include <cstring>
 
@@ -15,21 +17,17 @@ Tetris::Tetris()
     : screen_(nullptr),
       boardCanvas_(nullptr),
       scoreLabel_(nullptr),
-      nextPieceCanvas_(nullptr),
       dropTimer_(nullptr),
       currentPiece_{},
-      nextPiece_{},
-      pieces_{},
       score_(0),
       lines_(0),
       level_(1),
       dropSpeed_(1000),
       gameRunning_(false),
-      gen_(rd_()),
-      pieceDist_(0, PIECE_COUNT - 1)
+      gen_(rd_())
 {
-    initTetrominos();
-    memset(board_, 0, sizeof(board_));
+    memset(colors_, 0, sizeof(colors_));
+    memset(shown_, 0, sizeof(shown_));
 }
 
 
@@ -37,83 +35,19 @@ Tetris::~Tetris() {
     stop();
 }
 
-void Tetris::initTetrominos() {
-    // I-piece (cyan)
-    pieces_[I_PIECE].type = I_PIECE;
-    pieces_[I_PIECE].color = lv_color_make(255, 255, 0);
-    bool i_shape[4][4] = {
-        {0,0,0,0},
-        {1,1,1,1},
-        {0,0,0,0},
-        {0,0,0,0}
+// Same colors as before, indexed by piece type + 1 (the panel swaps red and blue)
+lv_color_t Tetris::pieceColor(uint8_t cell) {
+    static const uint8_t rgb[TetrisBoard::PIECE_COUNT + 1][3] = {
+        {0, 0, 0},          // empty
+        {255, 255, 0},      // I (cyan)
+        {0, 255, 255},      // O (yellow)
+        {128, 0, 128},      // T (purple)
+        {0, 255, 0},        // S (green)
+        {0, 0, 255},        // Z (red)
+        {255, 0, 0},        // J (blue)
+        {0, 165, 255},      // L (orange)
     };
-    memcpy(pieces_[I_PIECE].shape, i_shape, sizeof(i_shape));
-    
-    // O-piece (yellow)
-    pieces_[O_PIECE].type = O_PIECE;
-    pieces_[O_PIECE].color = lv_color_make(0, 255, 255);
-    bool o_shape[4][4] = {
-        {0,0,0,0},
-        {0,1,1,0},
-        {0,1,1,0},
-        {0,0,0,0}
-    };
-    memcpy(pieces_[O_PIECE].shape, o_shape, sizeof(o_shape));
-    
-    // T-piece (purple)
-    pieces_[T_PIECE].type = T_PIECE;
-    pieces_[T_PIECE].color = lv_color_make(128, 0, 128);
-    bool t_shape[4][4] = {
-        {0,0,0,0},
-        {0,1,0,0},
-        {1,1,1,0},
-        {0,0,0,0}
-    };
-    memcpy(pieces_[T_PIECE].shape, t_shape, sizeof(t_shape));
-    
-    // S-piece (green)
-    pieces_[S_PIECE].type = S_PIECE;
-    pieces_[S_PIECE].color = lv_color_make(0, 255, 0);
-    bool s_shape[4][4] = {
-        {0,0,0,0},
-        {0,1,1,0},
-        {1,1,0,0},
-        {0,0,0,0}
-    };
-    memcpy(pieces_[S_PIECE].shape, s_shape, sizeof(s_shape));
-    
-    // Z-piece (red)
-    pieces_[Z_PIECE].type = Z_PIECE;
-    pieces_[Z_PIECE].color = lv_color_make(0, 0, 255);
-    bool z_shape[4][4] = {
-        {0,0,0,0},
-        {1,1,0,0},
-        {0,1,1,0},
-        {0,0,0,0}
-    };
-    memcpy(pieces_[Z_PIECE].shape, z_shape, sizeof(z_shape));
-    
-    // J-piece (blue)
-    pieces_[J_PIECE].type = J_PIECE;
-    pieces_[J_PIECE].color = lv_color_make(255, 0, 0);
-    bool j_shape[4][4] = {
-        {0,0,0,0},
-        {1,0,0,0},
-        {1,1,1,0},
-        {0,0,0,0}
-    };
-    memcpy(pieces_[J_PIECE].shape, j_shape, sizeof(j_shape));
-    
-    // L-piece (orange)
-    pieces_[L_PIECE].type = L_PIECE;
-    pieces_[L_PIECE].color = lv_color_make(0, 165, 255);
-    bool l_shape[4][4] = {
-        {0,0,0,0},
-        {0,0,1,0},
-        {1,1,1,0},
-        {0,0,0,0}
-    };
-    memcpy(pieces_[L_PIECE].shape, l_shape, sizeof(l_shape));
+    return lv_color_make(rgb[cell][0], rgb[cell][1], rgb[cell][2]);
 }
 
 void Tetris::run() {
@@ -121,8 +55,18 @@ void Tetris::run() {
     resetGame();
     gameRunning_ = true;
     spawnTetromino();
+    render();
     
     dropTimer_ = lv_timer_create(dropTimerCallback, dropSpeed_, this);
+
+    if (autoplay_) {
+        lv_obj_t* demoLabel = lv_label_create(screen_);
+        lv_label_set_text(demoLabel, "DEMO\nPress any key");
+        lv_obj_align(demoLabel, LV_ALIGN_BOTTOM_RIGHT, -10, -10);
+        lv_obj_set_style_text_color(demoLabel, lv_color_make(255, 255, 255), 0);
+
+        autoplayTimer_ = lv_timer_create(autoplayTimerCallback, ATTRACT_STEP_MS, this);
+    }
 }
 
 void Tetris::update() {
@@ -136,9 +80,14 @@ void Tetris::stop() {
         lv_timer_del(dropTimer_);
         dropTimer_ = nullptr;
     }
+
+    if (autoplayTimer_) {
+        lv_timer_del(autoplayTimer_);
+        autoplayTimer_ = nullptr;
+    }
     
     if (screen_) {
-        lv_obj_del(screen_);
+        DeferredDeleter::instance().enqueue(screen_);
         screen_ = nullptr;
     }
 }
@@ -165,6 +114,12 @@ void Tetris::handleKey(uint32_t key) {
         case LV_KEY_ENTER:
             dropTetromino();
             break;
+
+        // UP+DOWN chord. gpio_driver.c holds UP and DOWN back until the chord can no
+        // longer form, so a hold never also rotates or soft-drops the piece.
+        case LV_KEY_NEXT:
+            holdTetromino();
+            break;
             
         case LV_KEY_ESC:
             stop();
@@ -229,20 +184,36 @@ void Tetris::createGameScreen() {
     lv_obj_set_style_text_color(scoreLabel_, lv_color_make(255, 255, 255), 0);
     lv_obj_set_style_text_font(scoreLabel_, &lv_font_montserrat_20, 0);
 
+    const int holdY = 150;
+    const int queueY = holdY + SLOT_HEIGHT + 40;
+
+    lv_obj_t* holdLabel = lv_label_create(screen_);
+    lv_label_set_text(holdLabel, "Hold:");
+    lv_obj_set_pos(holdLabel, 210, holdY - 20);
+    lv_obj_set_style_text_color(holdLabel, lv_color_make(255, 255, 255), 0);
+
+    lv_obj_t* holdPanel = createCleanObject(screen_);
+    lv_obj_set_size(holdPanel, SLOT_COLS * SLOT_PITCH + 6, SLOT_HEIGHT);
+    lv_obj_set_pos(holdPanel, 210, holdY);
+    lv_obj_set_style_bg_color(holdPanel, lv_color_make(32, 32, 32), 0);
+    lv_obj_set_style_border_width(holdPanel, 0, 0);
+    createSlots(holdPanel, HOLD_SLOT, 1);
+
     lv_obj_t* nextLabel = lv_label_create(screen_);
     lv_label_set_text(nextLabel, "Next:");
-    lv_obj_set_pos(nextLabel, 210, 150);
+    lv_obj_set_pos(nextLabel, 210, queueY - 20);
     lv_obj_set_style_text_color(nextLabel, lv_color_make(255, 255, 255), 0);
 
-    nextPieceCanvas_ = createCleanObject(screen_);
-    lv_obj_set_size(nextPieceCanvas_, 60, 60);
-    lv_obj_set_pos(nextPieceCanvas_, 210, 180);
-    lv_obj_set_style_bg_color(nextPieceCanvas_, lv_color_make(32, 32, 32), 0);
-    lv_obj_set_style_border_width(nextPieceCanvas_, 0, 0);
+    lv_obj_t* queuePanel = createCleanObject(screen_);
+    lv_obj_set_size(queuePanel, SLOT_COLS * SLOT_PITCH + 6, PREVIEW_COUNT * SLOT_HEIGHT);
+    lv_obj_set_pos(queuePanel, 210, queueY);
+    lv_obj_set_style_bg_color(queuePanel, lv_color_make(32, 32, 32), 0);
+    lv_obj_set_style_border_width(queuePanel, 0, 0);
+    createSlots(queuePanel, 0, PREVIEW_COUNT);
 
     lv_obj_t* controlsLabel = lv_label_create(screen_);
-    lv_label_set_text(controlsLabel, "<- -> Move\nv Drop 1 step\nEnter Drop\n^ Rotate");
-    lv_obj_set_pos(controlsLabel, 210, 280);
+    lv_label_set_text(controlsLabel, "<- -> Move\nv Drop 1 step\nEnter Drop\n^ Rotate\n^+v Hold");
+    lv_obj_set_pos(controlsLabel, 210, queueY + PREVIEW_COUNT * SLOT_HEIGHT + 10);
     lv_obj_set_style_text_color(controlsLabel, lv_color_make(200, 200, 200), 0);
 
     lv_scr_load(screen_);
@@ -255,179 +226,195 @@ void Tetris::resetGame() {
     lines_ = 0;
     level_ = 1;
     dropSpeed_ = 1000;
-    
-    memset(board_, 0, sizeof(board_));
-    drawBoard();
+
+    board_.clear();
+    memset(colors_, 0, sizeof(colors_));
+    render();
     updateScore();
-    
-    int pieceType = pieceDist_(gen_);
-    nextPiece_ = pieces_[pieceType];
-}
 
+    bag_.reset(gen_());
+    held_ = 0;
+    holdUsed_ = false;
+    drawSlot(HOLD_SLOT, 0);
+}
 
 void Tetris::spawnTetromino() {
-    currentPiece_ = nextPiece_;
-    currentPiece_.x = BOARD_WIDTH / 2 - 2;
+    startPiece(bag_.take());
+    drawQueue();
+}
+
+void Tetris::startPiece(TetrisBoard::Piece type) {
+    currentPiece_.type = type;
+    currentPiece_.x = TetrisBoard::SPAWN_X;
     currentPiece_.y = 0;
     currentPiece_.rotation = 0;
+    targetValid_ = false;
 
-    int pieceType = pieceDist_(gen_);
-    nextPiece_ = pieces_[pieceType];
-
-    if (nextPieceCanvas_) {
-        lv_obj_clean(nextPieceCanvas_);
-        for (int y = 0; y < 4; ++y) {
-            for (int x = 0; x < 4; ++x) {
-                if (nextPiece_.shape[y][x]) {
-                    lv_obj_t* cell = createCleanObject(nextPieceCanvas_);
-                    lv_obj_set_size(cell, 12, 12);
-                    lv_obj_set_pos(cell, x * 13, y * 13);
-                    lv_obj_set_style_bg_color(cell, nextPiece_.color, 0);
-                    lv_obj_set_style_border_width(cell, 0, 0);
-                }
-            }
-        }
+    if (!board_.fits(currentPiece_.type, 0, currentPiece_.x, currentPiece_.y)) {
+        gameOver();
     }
+}
 
-    if (!isValidPosition(currentPiece_.x, currentPiece_.y, currentPiece_.rotation)) {
-        gameRunning_ = false;
-        lv_obj_t* gameOverLabel = lv_label_create(screen_);
-        lv_label_set_text(gameOverLabel, "GAME OVER!");
-        lv_obj_set_style_text_font(gameOverLabel, &lv_font_montserrat_24, 0);
-        lv_obj_set_style_text_color(gameOverLabel, lv_color_make(255, 0, 0), 0);
-        lv_obj_center(gameOverLabel);
-        return;
+void Tetris::gameOver() {
+    gameRunning_ = false;
+    gameOverTicks_ = 0;
+    gameOverLabel_ = lv_label_create(screen_);
+    lv_label_set_text(gameOverLabel_, "GAME OVER!");
+    lv_obj_set_style_text_font(gameOverLabel_, &lv_font_montserrat_24, 0);
+    lv_obj_set_style_text_color(gameOverLabel_, lv_color_make(255, 0, 0), 0);
+    lv_obj_center(gameOverLabel_);
+}
+
+// Swaps the falling piece with the held one (or the next from the bag), once per piece
+void Tetris::holdTetromino() {
+    if (holdUsed_) return;
+
+    uint8_t previous = held_;
+    held_ = currentPiece_.type + 1;
+    if (previous) {
+        startPiece(static_cast<TetrisBoard::Piece>(previous - 1));
+    } else {
+        spawnTetromino();
     }
+    holdUsed_ = true;
 
-    drawTetromino();
+    drawSlot(HOLD_SLOT, held_);
+    render();
 }
 
-void Tetris::moveTetromino(int dx, int dy) {
-    if (isValidPosition(currentPiece_.x + dx, currentPiece_.y + dy, currentPiece_.rotation)) {
-        for (int y = 0; y < 4; y++) {
-            for (int x = 0; x < 4; x++) {
-                if (currentPiece_.shape[y][x]) {
-                    int boardX = currentPiece_.x + x;
-                    int boardY = currentPiece_.y + y;
-                    if (boardX >= 0 && boardX < BOARD_WIDTH && boardY >= 0 && boardY < BOARD_HEIGHT) {
-                        lv_obj_set_style_bg_color(cells_[boardY][boardX], lv_color_make(0, 0, 0), 0);
-                    }
-                }
+void Tetris::createSlots(lv_obj_t* panel, int first, int count) {
+    for (int slot = first; slot < first + count; slot++) {
+        int top = (slot - first) * SLOT_HEIGHT + 3;
+        for (int i = 0; i < SLOT_CELLS; i++) {
+            lv_obj_t* cell = createCleanObject(panel);
+            lv_obj_set_size(cell, SLOT_PITCH - 1, SLOT_PITCH - 1);
+            lv_obj_set_pos(cell, (i % SLOT_COLS) * SLOT_PITCH + 3, top + (i / SLOT_COLS) * SLOT_PITCH);
+            lv_obj_set_style_border_width(cell, 0, 0);
+            lv_obj_add_flag(cell, LV_OBJ_FLAG_HIDDEN);
+            slotCells_[slot][i] = cell;
+            slotShown_[slot][i] = 0;
+        }
+    }
+}
+
+// Piece type + 1 in its spawn state, 0 clears the slot. Untouched cells keep their style.
+void Tetris::drawSlot(int slot, uint8_t cell) {
+    for (int i = 0; i < SLOT_CELLS; i++) {
+        uint8_t target = 0;
+        if (cell && TetrisBoard::cell(static_cast<TetrisBoard::Piece>(cell - 1), 0, i % SLOT_COLS, i / SLOT_COLS)) {
+            target = cell;
+        }
+        if (target == slotShown_[slot][i]) continue;
+
+        lv_obj_t* obj = slotCells_[slot][i];
+        if (!target) {
+            lv_obj_add_flag(obj, LV_OBJ_FLAG_HIDDEN);
+        } else {
+            lv_obj_set_style_bg_color(obj, pieceColor(target), 0);
+            if (!slotShown_[slot][i]) {
+                lv_obj_clear_flag(obj, LV_OBJ_FLAG_HIDDEN);
             }
         }
-        
-        currentPiece_.x += dx;
-        currentPiece_.y += dy;
-        drawTetromino();
+        slotShown_[slot][i] = target;
+    }
+}
+
+void Tetris::drawQueue() {
+    for (int i = 0; i < PREVIEW_COUNT; i++) {
+        drawSlot(i, bag_.peek(i) + 1);
+    }
+}
+
+void Tetris::moveTetromino(int dx, int dy) {
+    Tetromino& p = currentPiece_;
+    if (board_.fits(p.type, p.rotation, p.x + dx, p.y + dy)) {
+        p.x += dx;
+        p.y += dy;
+        render();
     } else if (dy > 0) {
         lockTetromino();
     }
 }
 
 void Tetris::rotateTetromino() {
-    if (currentPiece_.type == O_PIECE) return;
-    
-    int newRotation = (currentPiece_.rotation + 1) % 4;
-    
-    Tetromino rotated = currentPiece_;
-    rotated.rotation = newRotation;
-    
-    bool newShape[4][4] = {0};
-    for (int y = 0; y < 4; y++) {
-        for (int x = 0; x < 4; x++) {
-            newShape[x][3-y] = currentPiece_.shape[y][x];
-        }
-    }
-    memcpy(rotated.shape, newShape, sizeof(newShape));
-    
-    if (isValidPosition(rotated.x, rotated.y, newRotation)) {
-        for (int y = 0; y < 4; y++) {
-            for (int x = 0; x < 4; x++) {
-                if (currentPiece_.shape[y][x]) {
-                    int boardX = currentPiece_.x + x;
-                    int boardY = currentPiece_.y + y;
-                    if (boardX >= 0 && boardX < BOARD_WIDTH && boardY >= 0 && boardY < BOARD_HEIGHT) {
-                        lv_obj_set_style_bg_color(cells_[boardY][boardX], lv_color_make(0, 0, 0), 0);
-                    }
-                }
-            }
-        }
-        
-        currentPiece_ = rotated;
-        drawTetromino();
+    Tetromino& p = currentPiece_;
+    if (board_.rotate(p.type, p.rotation, p.x, p.y, 1)) {
+        render();
     }
 }
 
+// The drop distance comes from the masks, the board is painted once
 void Tetris::dropTetromino() {
-    while (isValidPosition(currentPiece_.x, currentPiece_.y + 1, currentPiece_.rotation)) {
-        moveTetromino(0, 1);
-    }
+    Tetromino& p = currentPiece_;
+    p.y += board_.dropDistance(p.type, p.rotation, p.x, p.y);
     lockTetromino();
 }
 
 void Tetris::lockTetromino() {
+    const Tetromino& p = currentPiece_;
+    board_.place(p.type, p.rotation, p.x, p.y);
+    holdUsed_ = false;
+
+    bool lockOut = false;
     for (int y = 0; y < 4; y++) {
         for (int x = 0; x < 4; x++) {
-            if (currentPiece_.shape[y][x]) {
-                int boardX = currentPiece_.x + x;
-                int boardY = currentPiece_.y + y;
-                if (boardX >= 0 && boardX < BOARD_WIDTH && boardY >= 0 && boardY < BOARD_HEIGHT) {
-                    board_[boardY][boardX] = currentPiece_.type + 1;
-                }
+            int boardX = p.x + x;
+            int boardY = p.y + y;
+            if (!TetrisBoard::cell(p.type, p.rotation, x, y)) continue;
+            if (boardY < 0) {
+                lockOut = true;
+            } else if (boardY < BOARD_HEIGHT) {
+                colors_[boardY][boardX] = p.type + 1;
             }
         }
     }
-    
+
+    // Upward SRS kicks can lift a piece partly above the board near the top of
+    // the stack. Locking it there ends the game instead of losing those cells.
+    if (lockOut) {
+        gameOver();
+        render();
+        return;
+    }
+
     checkLines();
     spawnTetromino();
+    render();
 }
 
 void Tetris::checkLines() {
-    int linesCleared = 0;
-    
-    for (int y = BOARD_HEIGHT - 1; y >= 0; y--) {
-        bool fullLine = true;
-        for (int x = 0; x < BOARD_WIDTH; x++) {
-            if (board_[y][x] == 0) {
-                fullLine = false;
-                break;
-            }
-        }
-        
-        if (fullLine) {
-            for (int moveY = y; moveY > 0; moveY--) {
-                for (int x = 0; x < BOARD_WIDTH; x++) {
-                    board_[moveY][x] = board_[moveY - 1][x];
-                }
-            }
-            
-            for (int x = 0; x < BOARD_WIDTH; x++) {
-                board_[0][x] = 0;
-            }
-            
-            linesCleared++;
-            y++;
+    uint32_t cleared = board_.clearLines();
+    if (!cleared) return;
+
+    // Same compaction as the bitboard, on the colors
+    int write = BOARD_HEIGHT - 1;
+    for (int read = BOARD_HEIGHT - 1; read >= 0; read--) {
+        if (cleared & (1u << read)) continue;
+        if (write != read) {
+            memcpy(colors_[write], colors_[read], BOARD_WIDTH);
         }
+        write--;
     }
-    
-    if (linesCleared > 0) {
-        lines_ += linesCleared;
-        score_ += linesCleared * 100 * level_;
-        
-        int newLevel = lines_ / 10 + 1;
-        if (newLevel != level_) {
-            level_ = newLevel;
-            dropSpeed_ = 1000 - (level_ - 1) * 100;
-            if (dropSpeed_ < 100) dropSpeed_ = 100;
-            
-            if (dropTimer_) {
-                lv_timer_set_period(dropTimer_, dropSpeed_);
-            }
+    for (; write >= 0; write--) {
+        memset(colors_[write], 0, BOARD_WIDTH);
+    }
+
+    int linesCleared = __builtin_popcount(cleared);
+    lines_ += linesCleared;
+    score_ += linesCleared * 100 * level_;
+
+    int newLevel = lines_ / 10 + 1;
+    if (newLevel != level_) {
+        level_ = newLevel;
+        dropSpeed_ = 1000 - (level_ - 1) * 100;
+        if (dropSpeed_ < 100) dropSpeed_ = 100;
+
+        if (dropTimer_) {
+            lv_timer_set_period(dropTimer_, dropSpeed_);
         }
-        
-        updateScore();
-        drawBoard();
     }
+
+    updateScore();
 }
 
 void Tetris::updateScore() {
@@ -436,50 +423,32 @@ void Tetris::updateScore() {
     lv_label_set_text(scoreLabel_, scoreText);
 }
 
-void Tetris::drawBoard() {
-    for (int y = 0; y < BOARD_HEIGHT; y++) {
-        for (int x = 0; x < BOARD_WIDTH; x++) {
-            if (board_[y][x] > 0) {
-                lv_obj_set_style_bg_color(cells_[y][x], pieces_[board_[y][x] - 1].color, 0);
-            } else {
-                lv_obj_set_style_bg_color(cells_[y][x], lv_color_make(0, 0, 0), 0);
-            }
-        }
-    }
-}
+// Locked cells plus the falling piece, only cells that differ from what is shown are restyled
+void Tetris::render() {
+    uint8_t target[BOARD_HEIGHT][BOARD_WIDTH];
+    memcpy(target, colors_, sizeof(target));
 
-void Tetris::drawTetromino() {
-    for (int y = 0; y < 4; y++) {
-        for (int x = 0; x < 4; x++) {
-            if (currentPiece_.shape[y][x]) {
-                int boardX = currentPiece_.x + x;
-                int boardY = currentPiece_.y + y;
-                if (boardX >= 0 && boardX < BOARD_WIDTH && boardY >= 0 && boardY < BOARD_HEIGHT) {
-                    lv_obj_set_style_bg_color(cells_[boardY][boardX], currentPiece_.color, 0);
+    if (gameRunning_) {
+        const Tetromino& p = currentPiece_;
+        for (int y = 0; y < 4; y++) {
+            for (int x = 0; x < 4; x++) {
+                int boardX = p.x + x;
+                int boardY = p.y + y;
+                if (TetrisBoard::cell(p.type, p.rotation, x, y) && boardY >= 0 && boardY < BOARD_HEIGHT) {
+                    target[boardY][boardX] = p.type + 1;
                 }
             }
         }
     }
-}
 
-bool Tetris::isValidPosition(int x, int y, int rotation) {
-    for (int py = 0; py < 4; py++) {
-        for (int px = 0; px < 4; px++) {
-            if (currentPiece_.shape[py][px]) {
-                int boardX = x + px;
-                int boardY = y + py;
-                
-                if (boardX < 0 || boardX >= BOARD_WIDTH || boardY >= BOARD_HEIGHT) {
-                    return false;
-                }
-                
-                if (boardY >= 0 && board_[boardY][boardX] != 0) {
-                    return false;
-                }
+    for (int y = 0; y < BOARD_HEIGHT; y++) {
+        for (int x = 0; x < BOARD_WIDTH; x++) {
+            if (target[y][x] != shown_[y][x]) {
+                lv_obj_set_style_bg_color(cells_[y][x], pieceColor(target[y][x]), 0);
+                shown_[y][x] = target[y][x];
             }
         }
     }
-    return true;
 }
 
 void Tetris::dropTimerCallback(lv_timer_t* timer) {
@@ -487,4 +456,57 @@ void Tetris::dropTimerCallback(lv_timer_t* timer) {
     if (game && game->gameRunning_) {
         game->moveTetromino(0, 1);
     }
-}
\ No newline at end of file
+}
+
+// The placement is chosen once per piece and approached one move per call, so the
+// demo looks like someone playing. A target that can't be reached (blocked shift,
+// rotation kicked elsewhere) is given up after MAX_AUTOPLAY_STEPS with a hard drop.
+void Tetris::autoplayStep() {
+    if (!gameRunning_) {
+        if (++gameOverTicks_ * ATTRACT_STEP_MS >= ATTRACT_RESTART_MS) {
+            restartGame();
+        }
+        return;
+    }
+
+    if (!targetValid_) {
+        target_ = ai_.choose(board_, currentPiece_.type, bag_.peek(0));
+        targetValid_ = true;
+        autoplaySteps_ = 0;
+    }
+
+    const Tetromino& p = currentPiece_;
+    if (!target_.valid || ++autoplaySteps_ > MAX_AUTOPLAY_STEPS) {
+        dropTetromino();
+    } else if (p.rotation != target_.rotation) {
+        rotateTetromino();
+    } else if (p.x < target_.x) {
+        moveTetromino(1, 0);
+    } else if (p.x > target_.x) {
+        moveTetromino(-1, 0);
+    } else {
+        dropTetromino();
+    }
+}
+
+void Tetris::restartGame() {
+    if (gameOverLabel_) {
+        lv_obj_del(gameOverLabel_);
+        gameOverLabel_ = nullptr;
+    }
+
+    resetGame();
+    if (dropTimer_) {
+        lv_timer_set_period(dropTimer_, dropSpeed_);
+    }
+    gameRunning_ = true;
+    spawnTetromino();
+    render();
+}
+
+void Tetris::autoplayTimerCallback(lv_timer_t* timer) {
+    Tetris* game = static_cast<Tetris*>(lv_timer_get_user_data(timer));
+    if (game) {
+        game->autoplayStep();
+    }
+}
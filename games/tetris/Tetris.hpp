@@ -1,6 +1,9 @@
 #pragma once
 
 #include "Game.hpp"
+#include "TetrisBoard.hpp"
+#include "TetrisAI.hpp"
+#include "TetrisBag.hpp"
 #include "lvgl.h"
 #include <string>
 #include <vector>
@@ -16,60 +19,71 @@ public:
     void stop() override;
     void handleKey(uint32_t key) override;
     std::string name() const override { return "Tetris"; }
+    bool setAutoplay(bool enabled) override { autoplay_ = enabled; return true; }
 
 private:
-    static const int BOARD_WIDTH = 10;
-    static const int BOARD_HEIGHT = 20;
+    static const int BOARD_WIDTH = TetrisBoard::WIDTH;
+    static const int BOARD_HEIGHT = TetrisBoard::HEIGHT;
     static const int CELL_SIZE = 15;
-    
-    enum TetrominoType {
-        I_PIECE = 0,
-        O_PIECE,
-        T_PIECE,
-        S_PIECE,
-        Z_PIECE,
-        J_PIECE,
-        L_PIECE,
-        PIECE_COUNT
-    };
-    
+
+    // Queue and hold slots show the spawn state, which fits 4x2 cells for every piece.
+    // Their cells are created once and only restyled or hidden when the piece changes.
+    static const int PREVIEW_COUNT = 3;             // 1..TetrisBag::MAX_PREVIEW
+    static const int SLOT_COLS = 4;
+    static const int SLOT_ROWS = 2;
+    static const int SLOT_CELLS = SLOT_COLS * SLOT_ROWS;
+    static const int SLOT_PITCH = 13;
+    static const int SLOT_HEIGHT = SLOT_ROWS * SLOT_PITCH + 6;
+    static const int HOLD_SLOT = PREVIEW_COUNT;
+    static const int SLOT_COUNT = PREVIEW_COUNT + 1;
+
     struct Tetromino {
-        TetrominoType type;
+        TetrisBoard::Piece type;
         int x, y;
         int rotation;
-        bool shape[4][4];
-        lv_color_t color;
     };
-    
+
     void createGameScreen();
     void resetGame();
     void spawnTetromino();
+    void startPiece(TetrisBoard::Piece type);
+    void holdTetromino();
     void moveTetromino(int dx, int dy);
     void rotateTetromino();
     void dropTetromino();
     void lockTetromino();
     void checkLines();
+    void gameOver();
     void updateScore();
-    void drawBoard();
-    void drawTetromino();
-    bool isValidPosition(int x, int y, int rotation);
-    void initTetrominos();
-    void clearNextPieceCanvas();
+    void render();
+    void createSlots(lv_obj_t* panel, int first, int count);
+    void drawSlot(int slot, uint8_t cell);
+    void drawQueue();
+    static lv_color_t pieceColor(uint8_t cell);
+    void autoplayStep();
+    void restartGame();
 
     static void dropTimerCallback(lv_timer_t* timer);
+    static void autoplayTimerCallback(lv_timer_t* timer);
     
     lv_obj_t* screen_;
     lv_obj_t* boardCanvas_;
     lv_obj_t* scoreLabel_;
-    lv_obj_t* nextPieceCanvas_;
     lv_timer_t* dropTimer_;
     
-    uint8_t board_[BOARD_HEIGHT][BOARD_WIDTH];
+    // Collision and line clears run on the bitboard, colors_ only keeps what to paint
+    TetrisBoard board_;
+    uint8_t colors_[BOARD_HEIGHT][BOARD_WIDTH];     // piece type + 1, 0 when empty
+    uint8_t shown_[BOARD_HEIGHT][BOARD_WIDTH];      // what cells_ currently show
     lv_obj_t* cells_[BOARD_HEIGHT][BOARD_WIDTH];
-    
+
     Tetromino currentPiece_;
-    Tetromino nextPiece_;
-    Tetromino pieces_[PIECE_COUNT];
+    TetrisBag bag_;
+    uint8_t held_ = 0;          // piece type + 1, 0 when nothing is held
+    bool holdUsed_ = false;     // once per piece, until it locks
+
+    lv_obj_t* slotCells_[SLOT_COUNT][SLOT_CELLS] = {};
+    uint8_t slotShown_[SLOT_COUNT][SLOT_CELLS] = {};
     
     int score_;
     int lines_;
@@ -77,9 +91,19 @@ private:
     int dropSpeed_;
     bool gameRunning_;
     
+    // Attract mode: one move towards the chosen placement per ATTRACT_STEP_MS
+    static const int MAX_AUTOPLAY_STEPS = 12;
+    bool autoplay_ = false;
+    lv_timer_t* autoplayTimer_ = nullptr;
+    lv_obj_t* gameOverLabel_ = nullptr;
+    TetrisAI ai_;
+    TetrisAI::Placement target_ = {};
+    bool targetValid_ = false;
+    int autoplaySteps_ = 0;
+    uint32_t gameOverTicks_ = 0;
+
     std::random_device rd_;
     std::mt19937 gen_;
-    std::uniform_int_distribution<> pieceDist_;
 };
 
 struct RegisterTetris {
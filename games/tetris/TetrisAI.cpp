@@ -0,0 +1,93 @@
+#include "TetrisAI.hpp"
+#include <cfloat>
+
+// Weights from the well known genetic tuning of the four feature heuristic
+static const float HEIGHT_WEIGHT = -0.510066f;
+static const float LINES_WEIGHT = 0.760666f;
+static const float HOLES_WEIGHT = -0.35663f;
+static const float BUMPINESS_WEIGHT = -0.184483f;
+
+// Leftmost box column that can still hold a piece, see TetrisBoard::fits()
+static const int MIN_X = -3;
+
+TetrisAI::Placement TetrisAI::choose(const TetrisBoard& board, TetrisBoard::Piece current, TetrisBoard::Piece next) {
+    Placement best = {0, 0, 0, false};
+    float bestScore = -FLT_MAX;
+
+    for (int r = 0; r < rotations(current); r++) {
+        for (int x = MIN_X; x < TetrisBoard::WIDTH; x++) {
+            if (!board.fits(current, r, x, 0)) continue;
+
+            int y = board.dropDistance(current, r, x, 0);
+            TetrisBoard after = board;
+            after.place(current, r, x, y);
+            int lines = __builtin_popcount(after.clearLines());
+
+            float score = bestFollowUp(after, next, lines);
+            if (score > bestScore) {
+                bestScore = score;
+                best = {r, x, y, true};
+            }
+        }
+    }
+
+    return best;
+}
+
+// Best score over all drops of the preview piece, or the board itself if it has none
+float TetrisAI::bestFollowUp(const TetrisBoard& board, TetrisBoard::Piece piece, int lines) {
+    float best = -FLT_MAX;
+
+    for (int r = 0; r < rotations(piece); r++) {
+        for (int x = MIN_X; x < TetrisBoard::WIDTH; x++) {
+            if (!board.fits(piece, r, x, 0)) continue;
+
+            TetrisBoard after = board;
+            after.place(piece, r, x, board.dropDistance(piece, r, x, 0));
+            int total = lines + __builtin_popcount(after.clearLines());
+
+            float score = evaluate(after, total);
+            searched_++;
+            if (score > best) {
+                best = score;
+            }
+        }
+    }
+
+    if (best == -FLT_MAX) {
+        searched_++;
+        return evaluate(board, lines);
+    }
+    return best;
+}
+
+// One pass from the top: the first row a column shows up in gives its height,
+// every empty cell below an occupied one in the same column is a hole
+float TetrisAI::evaluate(const TetrisBoard& board, int lines) {
+    int heights[TetrisBoard::WIDTH] = {0};
+    int holes = 0;
+    uint16_t seen = 0;
+
+    for (int y = 0; y < TetrisBoard::HEIGHT; y++) {
+        uint16_t row = board.row(y);
+        uint16_t fresh = row & ~seen;
+        while (fresh) {
+            heights[__builtin_ctz(fresh)] = TetrisBoard::HEIGHT - y;
+            fresh &= fresh - 1;
+        }
+        holes += __builtin_popcount(seen & ~row);
+        seen |= row;
+    }
+
+    int height = 0;
+    int bumpiness = 0;
+    for (int x = 0; x < TetrisBoard::WIDTH; x++) {
+        height += heights[x];
+        if (x > 0) {
+            int d = heights[x] - heights[x - 1];
+            bumpiness += d < 0 ? -d : d;
+        }
+    }
+
+    return HEIGHT_WEIGHT * height + LINES_WEIGHT * lines + HOLES_WEIGHT * holes + BUMPINESS_WEIGHT * bumpiness;
+}
@@ -0,0 +1,34 @@
+#pragma once
+
+#include "TetrisBoard.hpp"
+#include <cstdint>
+
+// Placement search for the attract mode and the CPU benchmark. Every drop of the
+// current piece straight down from the top row (no slides under overhangs) is
+// combined with every drop of the preview piece, and the resulting board is
+// scored with the usual four features (aggregate height, cleared lines, holes,
+// bumpiness). Works on board copies only.
+class TetrisAI {
+public:
+    struct Placement {
+        int rotation;
+        int x;
+        int y;          // resting row of the box
+        bool valid;     // false if the piece can't be placed at all
+    };
+
+    Placement choose(const TetrisBoard& board, TetrisBoard::Piece current, TetrisBoard::Piece next);
+
+    // Boards evaluated since the last reset, one per searched placement pair
+    uint32_t searched() const { return searched_; }
+    void resetStats() { searched_ = 0; }
+
+private:
+    // O looks the same in every orientation
+    static int rotations(TetrisBoard::Piece p) { return p == TetrisBoard::O_PIECE ? 1 : 4; }
+
+    float bestFollowUp(const TetrisBoard& board, TetrisBoard::Piece piece, int lines);
+    static float evaluate(const TetrisBoard& board, int lines);
+
+    uint32_t searched_ = 0;
+};
@@ -0,0 +1,65 @@
+#pragma once
+
+#include "TetrisBoard.hpp"
+#include <cstdint>
+
+// 7-bag randomizer: every run of seven pieces holds each piece once, so droughts
+// are bounded. Upcoming pieces are kept in a fixed ring that the preview reads
+// directly, taking a piece never allocates or moves memory.
+class TetrisBag {
+public:
+    static const int MAX_PREVIEW = 6;
+
+    void reset(uint32_t seed) {
+        rng_ = seed ? seed : 1;
+        bagPos_ = BAG_SIZE;
+        head_ = 0;
+        for (int i = 0; i < MAX_PREVIEW; i++) {
+            queue_[i] = draw();
+        }
+    }
+
+    TetrisBoard::Piece take() {
+        TetrisBoard::Piece piece = queue_[head_];
+        queue_[head_] = draw();
+        head_ = (head_ + 1) % MAX_PREVIEW;
+        return piece;
+    }
+
+    // i-th upcoming piece, 0 is the one take() returns next
+    TetrisBoard::Piece peek(int i) const { return queue_[(head_ + i) % MAX_PREVIEW]; }
+
+private:
+    static const int BAG_SIZE = TetrisBoard::PIECE_COUNT;
+
+    TetrisBoard::Piece draw() {
+        if (bagPos_ == BAG_SIZE) {
+            // Fisher-Yates over a fresh bag
+            for (int i = 0; i < BAG_SIZE; i++) {
+                bag_[i] = static_cast<TetrisBoard::Piece>(i);
+            }
+            for (int i = BAG_SIZE - 1; i > 0; i--) {
+                int j = next() % (i + 1);
+                TetrisBoard::Piece t = bag_[i];
+                bag_[i] = bag_[j];
+                bag_[j] = t;
+            }
+            bagPos_ = 0;
+        }
+        return bag_[bagPos_++];
+    }
+
+    // xorshift32
+    uint32_t next() {
+        rng_ ^= rng_ << 13;
+        rng_ ^= rng_ >> 17;
+        rng_ ^= rng_ << 5;
+        return rng_;
+    }
+
+    TetrisBoard::Piece bag_[BAG_SIZE] = {};
+    TetrisBoard::Piece queue_[MAX_PREVIEW] = {};
+    int bagPos_ = BAG_SIZE;
+    int head_ = 0;
+    uint32_t rng_ = 1;
+};
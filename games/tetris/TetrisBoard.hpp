@@ -0,0 +1,212 @@
+#pragma once
+
+#include <cstdint>
+
+// Piece masks are 4x4 boxes packed into uint16_t, row r in bits 4r..4r+3 and bit 0
+// of every row the left column. Indexed [piece][rotation] in TetrisBoard::Piece order.
+struct TetrisShapeTable {
+    uint16_t v[7][4];
+};
+
+constexpr uint16_t tetrisRows(uint8_t r0, uint8_t r1, uint8_t r2, uint8_t r3) {
+    return r0 | (r1 << 4) | (r2 << 8) | (r3 << 12);
+}
+
+// Cell (x, y) of an n x n rotation box goes to (n-1-y, x)
+constexpr uint16_t tetrisRotateCw(uint16_t mask, int n) {
+    uint16_t out = 0;
+    for (int y = 0; y < n; y++) {
+        for (int x = 0; x < n; x++) {
+            if ((mask >> (y * 4 + x)) & 1) {
+                out |= 1u << (x * 4 + (n - 1 - y));
+            }
+        }
+    }
+    return out;
+}
+
+constexpr TetrisShapeTable buildTetrisShapes() {
+    // SRS spawn states and rotation box sizes, O is never rotated
+    const uint16_t spawn[7] = {
+        tetrisRows(0b0000, 0b1111, 0b0000, 0b0000),   // I
+        tetrisRows(0b0110, 0b0110, 0b0000, 0b0000),   // O
+        tetrisRows(0b0010, 0b0111, 0b0000, 0b0000),   // T
+        tetrisRows(0b0110, 0b0011, 0b0000, 0b0000),   // S
+        tetrisRows(0b0011, 0b0110, 0b0000, 0b0000),   // Z
+        tetrisRows(0b0001, 0b0111, 0b0000, 0b0000),   // J
+        tetrisRows(0b0100, 0b0111, 0b0000, 0b0000),   // L
+    };
+    const int box[7] = {4, 0, 3, 3, 3, 3, 3};
+
+    TetrisShapeTable t = {};
+    for (int p = 0; p < 7; p++) {
+        t.v[p][0] = spawn[p];
+        for (int r = 1; r < 4; r++) {
+            t.v[p][r] = box[p] ? tetrisRotateCw(t.v[p][r - 1], box[p]) : spawn[p];
+        }
+    }
+    return t;
+}
+
+inline constexpr TetrisShapeTable TETRIS_SHAPES = buildTetrisShapes();
+
+// Bitboard Tetris playfield. Every row is a uint16_t mask with the 10 columns in
+// bits 3..12 and solid walls around them, so collision with walls, floor and
+// stack is one AND per piece row. All 28 piece orientations are built at
+// compile time.
+class TetrisBoard {
+public:
+    static const int WIDTH = 10;
+    static const int HEIGHT = 20;
+
+    enum Piece : uint8_t {
+        I_PIECE = 0,
+        O_PIECE,
+        T_PIECE,
+        S_PIECE,
+        Z_PIECE,
+        J_PIECE,
+        L_PIECE,
+        PIECE_COUNT
+    };
+
+    // Orientation r of piece p, rotations are clockwise from the SRS spawn state
+    static constexpr uint16_t shape(Piece p, int r) { return TETRIS_SHAPES.v[p][r & 3]; }
+
+    static constexpr bool cell(Piece p, int r, int cx, int cy) {
+        return (shape(p, r) >> (cy * 4 + cx)) & 1;
+    }
+
+    TetrisBoard() { clear(); }
+
+    void clear() {
+        for (auto& row : rows_) {
+            row = EMPTY_ROW;
+        }
+    }
+
+    // Occupied playfield columns of row y, bit x = column x
+    uint16_t row(int y) const { return (rows_[y] >> WALL) & FIELD; }
+
+    bool occupied(int x, int y) const { return (row(y) >> x) & 1; }
+
+    // Box top-left at column x, row y. Rows above the field only have the walls.
+    bool fits(Piece p, int r, int x, int y) const {
+        if (x < -WALL) return false;
+
+        uint16_t s = shape(p, r);
+        for (int i = 0; i < 4; i++, s >>= 4) {
+            uint32_t bits = s & 0xF;
+            if (!bits) continue;
+
+            int rowY = y + i;
+            if (rowY >= HEIGHT) return false;
+
+            // Bits shifted past the mask are outside the right wall
+            uint32_t line = rowY < 0 ? EMPTY_ROW : rows_[rowY];
+            if ((bits << (x + WALL)) & (line | 0xFFFF0000u)) return false;
+        }
+        return true;
+    }
+
+    // Rows the piece can fall from y before it rests on something
+    int dropDistance(Piece p, int r, int x, int y) const {
+        int d = 0;
+        while (fits(p, r, x, y + d + 1)) {
+            d++;
+        }
+        return d;
+    }
+
+    // Cells above the board are not stored, the caller treats them as a lock-out
+    void place(Piece p, int r, int x, int y) {
+        uint16_t s = shape(p, r);
+        for (int i = 0; i < 4; i++, s >>= 4) {
+            int rowY = y + i;
+            if ((s & 0xF) && rowY >= 0 && rowY < HEIGHT) {
+                rows_[rowY] |= (s & 0xF) << (x + WALL);
+            }
+        }
+    }
+
+    // Removes full rows by compacting the rest downwards. Returns a mask of the
+    // cleared rows (bit y = row y before the compaction).
+    uint32_t clearLines() {
+        uint32_t cleared = 0;
+        int write = HEIGHT - 1;
+        for (int read = HEIGHT - 1; read >= 0; read--) {
+            if (rows_[read] == FULL_ROW) {
+                cleared |= 1u << read;
+            } else {
+                rows_[write--] = rows_[read];
+            }
+        }
+        while (write >= 0) {
+            rows_[write--] = EMPTY_ROW;
+        }
+        return cleared;
+    }
+
+    // SRS rotation by dir (+1 clockwise, -1 counter-clockwise). Tries the five kick
+    // offsets in order and updates r, x and y with the first one that fits.
+    bool rotate(Piece p, int& r, int& x, int& y, int dir) const {
+        if (p == O_PIECE) return true;
+
+        int from = r & 3;
+        int to = (r + dir) & 3;
+        const int8_t (*kicks)[2] = (p == I_PIECE)
+            ? (dir > 0 ? I_KICKS_CW[from] : I_KICKS_CCW[from])
+            : (dir > 0 ? JLSTZ_KICKS_CW[from] : JLSTZ_KICKS_CCW[from]);
+
+        for (int i = 0; i < KICK_TESTS; i++) {
+            // The tables use y up, the board y down
+            int kx = x + kicks[i][0];
+            int ky = y - kicks[i][1];
+            if (fits(p, to, kx, ky)) {
+                r = to;
+                x = kx;
+                y = ky;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // Box column a piece spawns at
+    static const int SPAWN_X = 3;
+
+private:
+    static const int WALL = 3;
+    static const uint16_t FIELD = (1u << WIDTH) - 1;
+    static const uint16_t FULL_ROW = 0xFFFF;
+    static const uint16_t EMPTY_ROW = static_cast<uint16_t>(~(FIELD << WALL));
+    static const int KICK_TESTS = 5;
+
+    // SRS kick offsets (x right, y up), indexed by the rotation state rotated from
+    static constexpr int8_t JLSTZ_KICKS_CW[4][KICK_TESTS][2] = {
+        {{0, 0}, {-1, 0}, {-1,  1}, {0, -2}, {-1, -2}},   // 0 -> R
+        {{0, 0}, { 1, 0}, { 1, -1}, {0,  2}, { 1,  2}},   // R -> 2
+        {{0, 0}, { 1, 0}, { 1,  1}, {0, -2}, { 1, -2}},   // 2 -> L
+        {{0, 0}, {-1, 0}, {-1, -1}, {0,  2}, {-1,  2}},   // L -> 0
+    };
+    static constexpr int8_t JLSTZ_KICKS_CCW[4][KICK_TESTS][2] = {
+        {{0, 0}, { 1, 0}, { 1,  1}, {0, -2}, { 1, -2}},   // 0 -> L
+        {{0, 0}, { 1, 0}, { 1, -1}, {0,  2}, { 1,  2}},   // R -> 0
+        {{0, 0}, {-1, 0}, {-1,  1}, {0, -2}, {-1, -2}},   // 2 -> R
+        {{0, 0}, {-1, 0}, {-1, -1}, {0,  2}, {-1,  2}},   // L -> 2
+    };
+    static constexpr int8_t I_KICKS_CW[4][KICK_TESTS][2] = {
+        {{0, 0}, {-2, 0}, { 1, 0}, {-2, -1}, { 1,  2}},   // 0 -> R
+        {{0, 0}, {-1, 0}, { 2, 0}, {-1,  2}, { 2, -1}},   // R -> 2
+        {{0, 0}, { 2, 0}, {-1, 0}, { 2,  1}, {-1, -2}},   // 2 -> L
+        {{0, 0}, { 1, 0}, {-2, 0}, { 1, -2}, {-2,  1}},   // L -> 0
+    };
+    static constexpr int8_t I_KICKS_CCW[4][KICK_TESTS][2] = {
+        {{0, 0}, {-1, 0}, { 2, 0}, {-1,  2}, { 2, -1}},   // 0 -> L
+        {{0, 0}, { 2, 0}, {-1, 0}, { 2,  1}, {-1, -2}},   // R -> 0
+        {{0, 0}, { 1, 0}, {-2, 0}, { 1, -2}, {-2,  1}},   // 2 -> R
+        {{0, 0}, {-2, 0}, { 1, 0}, {-2, -1}, { 1,  2}},   // L -> 2
+    };
+
+    uint16_t rows_[HEIGHT];
+};
@@ -1,6 +1,7 @@
 #include "TowerBloxx.hpp"
 #include "GameRegistry.hpp"
 #include "lvgl_helper.hpp"
+#include "DeferredDeleter.hpp"
 #include "base.h"
 #include "blue_centre.h"
 #include "red_centre.h"
@@ -91,7 +92,7 @@ void TowerBloxx::stop() {
     
     if (screen_) {
         ESP_LOGI(TAG, "Deleting screen");
-        lv_obj_del(screen_);
+        DeferredDeleter::instance().enqueue(screen_);
         screen_ = nullptr;
         gameContainer_ = nullptr;
         scoreLabel_ = nullptr;
@@ -6,6 +6,8 @@
 
 #define TAG "DISPLAY DRIVER"
 
+static uint64_t s_tx_bytes = 0;
+
 esp_err_t panel_ili9481_del(esp_lcd_panel_t *panel)
 {
     panel_ili9481_t *ili = __containerof(panel, panel_ili9481_t, base);
@@ -147,9 +149,16 @@ esp_err_t panel_ili9481_draw_bitmap(esp_lcd_panel_t *panel,
         return err;
     }
 
+    s_tx_bytes += pixel_count * 2;
+
     return ESP_OK;
 }
 
+uint64_t panel_ili9481_get_tx_bytes(void)
+{
+    return s_tx_bytes;
+}
+
 esp_err_t panel_ili9481_invert_color(esp_lcd_panel_t *panel, bool invert_color_data)
 {
     panel_ili9481_t *ili = __containerof(panel, panel_ili9481_t, base);
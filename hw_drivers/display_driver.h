@@ -129,4 +129,10 @@ esp_err_t esp_lcd_new_panel_ili9481(const esp_lcd_panel_io_handle_t io,
                                     esp_lcd_panel_handle_t *ret_panel);
 
 
+/***************************************************************************************************
+ * Total number of color bytes sent by panel_ili9481_draw_bitmap since boot
+ **************************************************************************************************/
+uint64_t panel_ili9481_get_tx_bytes(void);
+
+
 esp_err_t init_lcd_display(esp_lcd_panel_handle_t *panel, esp_lcd_panel_io_handle_t *io_handle);
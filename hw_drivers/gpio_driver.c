@@ -5,9 +5,11 @@
 #include "soc/gpio_struct.h"
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
+#include <stdbool.h>
 #include <stdint.h>
 #include <stdio.h>
 #include "esp_log.h"
+#include "esp_timer.h"
 
 static const char *TAG = "GPIO_DRIVER";
 
@@ -31,6 +33,125 @@ static button_state_t buttons[] = {
 
 #define BUTTON_COUNT (sizeof(buttons) / sizeof(buttons[0]))
 #define DEBOUNCE_TIME_MS 50
+#define CHORD_WINDOW_MS 50
+
+// Two buttons held together produce a separate key. A button that is part of a
+// chord does not send its own key right away: it is held back for CHORD_WINDOW_MS.
+// If the partner goes down within the window only the chord key is sent, otherwise
+// the single key follows when the window ends or the button is released, whichever
+// comes first. Both buttons' own edges are consumed by the chord.
+typedef struct {
+    int pin_a;
+    int pin_b;
+    int lv_key;
+    bool latched;
+    const char* name;
+} button_chord_t;
+
+// Every button listed here gets the CHORD_WINDOW_MS delay on its own key
+static button_chord_t chords[] = {
+    {INCREASE_BTN, DECREASE_BTN, LV_KEY_HOME, false, "PROFILER_CHORD"},
+    {NEXT_BTN,     PREV_BTN,     LV_KEY_NEXT, false, "HOLD_CHORD"}     // Tetris hold, 2048 autoplay
+};
+
+#define CHORD_COUNT (sizeof(chords) / sizeof(chords[0]))
+
+static TaskHandle_t wake_task = NULL;
+
+// Chord button pressed alone so far, index into buttons[] or -1
+static int deferred_button = -1;
+// Set by chord_timer when the window ends, which also wakes the reader
+static volatile bool deferred_expired = false;
+static esp_timer_handle_t chord_timer = NULL;
+
+static
+void IRAM_ATTR button_isr_handler(void *arg)
+{
+    BaseType_t higher_priority_woken = pdFALSE;
+
+    if (wake_task) {
+        vTaskNotifyGiveIndexedFromISR(wake_task, LVGL_WAKE_NOTIFY_INDEX, &higher_priority_woken);
+    }
+    portYIELD_FROM_ISR(higher_priority_woken);
+}
+
+static
+void wake_reader(void)
+{
+    if (wake_task) {
+        xTaskNotifyGiveIndexed(wake_task, LVGL_WAKE_NOTIFY_INDEX);
+    }
+}
+
+static
+void chord_timer_cb(void *arg)
+{
+    deferred_expired = true;
+    wake_reader();
+}
+
+static
+bool in_chord(int pin)
+{
+    for (int i = 0; i < CHORD_COUNT; i++) {
+        if (chords[i].pin_a == pin || chords[i].pin_b == pin) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// Pressed and not sent yet: held back, or an edge not seen by the button loop
+static
+bool press_unsent(int pin)
+{
+    for (int i = 0; i < BUTTON_COUNT; i++) {
+        if (buttons[i].pin == pin) {
+            return i == deferred_button || buttons[i].previous_state == 1;
+        }
+    }
+    return false;
+}
+
+static
+void clear_deferred(void)
+{
+    deferred_button = -1;
+    esp_timer_stop(chord_timer);
+}
+
+static
+void consume_button_edge(int pin)
+{
+    for (int i = 0; i < BUTTON_COUNT; i++) {
+        if (buttons[i].pin == pin) {
+            buttons[i].previous_state = 0;
+        }
+    }
+}
+
+static
+int read_chords()
+{
+    for (int i = 0; i < CHORD_COUNT; i++) {
+        button_chord_t* chord = &chords[i];
+        bool held = gpio_get_level(chord->pin_a) == 0 && gpio_get_level(chord->pin_b) == 0;
+
+        // A button whose own key already went out no longer forms a chord
+        if (held && !chord->latched && press_unsent(chord->pin_a) && press_unsent(chord->pin_b)) {
+            chord->latched = true;
+            consume_button_edge(chord->pin_a);
+            consume_button_edge(chord->pin_b);
+
+            ESP_LOGI(TAG, "%s pressed", chord->name);
+            return chord->lv_key;
+        } else if (!held) {
+            chord->latched = false;
+        }
+    }
+
+    return -1;
+}
 
 static
 void init_input_pins() {
@@ -43,9 +164,29 @@ void init_input_pins() {
     io_conf.mode = GPIO_MODE_INPUT;
     io_conf.pull_up_en = GPIO_PULLUP_ENABLE;
     io_conf.pull_down_en = GPIO_PULLDOWN_DISABLE;
-    io_conf.intr_type = GPIO_INTR_DISABLE;
+    io_conf.intr_type = GPIO_INTR_ANYEDGE;
 
     gpio_config(&io_conf);
+
+    // Edges only wake the reader, debouncing stays in read_button()
+    esp_err_t err = gpio_install_isr_service(0);
+    if (err != ESP_OK && err != ESP_ERR_INVALID_STATE) {
+        ESP_LOGE(TAG, "Failed to install GPIO ISR service: %s", esp_err_to_name(err));
+        return;
+    }
+
+    for (int i = 0; i < BUTTON_COUNT; i++) {
+        gpio_isr_handler_add(buttons[i].pin, button_isr_handler, NULL);
+    }
+
+    const esp_timer_create_args_t timer_args = {
+        .callback = chord_timer_cb,
+        .name = "chord_window",
+    };
+    err = esp_timer_create(&timer_args, &chord_timer);
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to create the chord timer: %s", esp_err_to_name(err));
+    }
 }
 
 void init_gpio() {
@@ -75,6 +216,22 @@ void init_gpio() {
 
 int read_button() {
     uint32_t current_time = xTaskGetTickCount() * portTICK_PERIOD_MS;
+
+    int chord_key = read_chords();
+    if (chord_key >= 0) {
+        clear_deferred();
+        return chord_key;
+    }
+
+    // No partner came in time, or the button is already up: it was a single press
+    if (deferred_button >= 0) {
+        button_state_t* btn = &buttons[deferred_button];
+        if (deferred_expired || gpio_get_level(btn->pin) == 1) {
+            clear_deferred();
+            ESP_LOGI(TAG, "%s pressed (debounced)", btn->name);
+            return btn->lv_key;
+        }
+    }
     
     for (int i = 0; i < BUTTON_COUNT; i++) {
         button_state_t* btn = &buttons[i];
@@ -83,8 +240,25 @@ int read_button() {
         
         if (btn->previous_state == 1 && btn->current_state == 0) {
             if (current_time - btn->last_press_time >= DEBOUNCE_TIME_MS) {
+                // Another button while one is held back: send the held one first,
+                // this edge stays for the next read
+                if (deferred_button >= 0) {
+                    button_state_t* held = &buttons[deferred_button];
+                    clear_deferred();
+                    wake_reader();
+                    ESP_LOGI(TAG, "%s pressed (debounced)", held->name);
+                    return held->lv_key;
+                }
+
                 btn->last_press_time = current_time;
                 btn->previous_state = btn->current_state;
+
+                if (in_chord(btn->pin)) {
+                    deferred_button = i;
+                    deferred_expired = false;
+                    esp_timer_start_once(chord_timer, CHORD_WINDOW_MS * 1000);
+                    continue;
+                }
                 
                 ESP_LOGI(TAG, "%s pressed (debounced)", btn->name);
                 return btn->lv_key;
@@ -97,5 +271,10 @@ int read_button() {
     return -1;
 }
 
+void set_button_wake_task(TaskHandle_t task)
+{
+    wake_task = task;
+}
+
 // pins: 1, 2, 3, 38, 41, 42, 47, 48
 // connected: 47, 48, 38, 41, 42
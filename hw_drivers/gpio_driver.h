@@ -1,6 +1,11 @@
 #pragma once
 
 #include <stdint.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
 
 void init_gpio();
 int read_button();
+
+// Task notified (LVGL_WAKE_NOTIFY_INDEX) from the button ISR on every edge of any input pin
+void set_button_wake_task(TaskHandle_t task);
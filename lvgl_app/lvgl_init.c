@@ -7,6 +7,10 @@
 #include "esp_freertos_hooks.h"
 #include "gpio_driver.h"
 #include "display_driver.h"
+#include "frame_profiler.h"
+#include "render_stats.h"
+#include "alloc_tracker.h"
+#include "mem_policy.h"
 
 
 static const char *TAG = "lvgl_init";
@@ -14,6 +18,14 @@ void (*handle_input_event)(uint32_t key) = NULL;
 
 static esp_lcd_panel_io_handle_t lcd_io_handle = NULL;
 static esp_lcd_panel_handle_t panel_handle = NULL;
+static lv_indev_t *keypad_indev = NULL;
+static TaskHandle_t lvgl_task = NULL;
+
+#define FLUSH_TIMEOUT_MS    100
+
+// Set in flush_cb, cleared by the DMA completion ISR
+static volatile bool flush_pending = false;
+static TaskHandle_t flush_task = NULL;
 
 static void button_read(lv_indev_t * indev, lv_indev_data_t * data)
 {
@@ -43,13 +55,46 @@ void IRAM_ATTR lv_tick_hook(void)
     lv_tick_inc(portTICK_PERIOD_MS);
 }
 
+static
+void wake_lvgl_task(void)
+{
+    if (lvgl_task) {
+        xTaskNotifyGiveIndexed(lvgl_task, LVGL_WAKE_NOTIFY_INDEX);
+    }
+}
+
+// A timer was created or resumed (e.g. lv_async_call from the logic task) while the handler sleeps
+static
+void timer_resume_cb(void *data)
+{
+    wake_lvgl_task();
+}
+
+// Something got invalidated, possibly from another task
+static
+void refr_request_cb(lv_event_t *e)
+{
+    wake_lvgl_task();
+}
+
+// Sleeps until the next LVGL timer is due or until a button edge, invalidation
+// or new timer notifies the task. The keypad is in event mode and read on wake-up.
 IRAM_ATTR static
 void timer_handler(void *pvParameters) {
     uint32_t next_run = 0;
+    // Everything this task allocates outside the refresh belongs to LVGL timers
+    alloc_tracker_enter(ALLOC_SCOPE_TIMERS);
     while(true) {
-        if(next_run < 5) next_run = 5;
-        vTaskDelay(pdMS_TO_TICKS(next_run));
+        TickType_t wait = (next_run == LV_NO_TIMER_READY) ? portMAX_DELAY : pdMS_TO_TICKS(next_run);
+        ulTaskNotifyTakeIndexed(LVGL_WAKE_NOTIFY_INDEX, pdTRUE, wait > 0 ? wait : 1);
+        frame_profiler_timers_begin();
+        // lv_timer_handler takes the LVGL lock itself, the input read (and the
+        // ScreenManager code it calls) needs it too
+        lv_lock();
+        lv_indev_read(keypad_indev);
+        lv_unlock();
         next_run = lv_timer_handler();
+        frame_profiler_timers_end();
         //ESP_LOGD(TAG, "Timer handler called, next Run in: %ld ms", next_run);
     }
 }
@@ -57,8 +102,26 @@ void timer_handler(void *pvParameters) {
 static
 bool transaction_done_cb(esp_lcd_panel_io_handle_t panel_io, esp_lcd_panel_io_event_data_t *edata, void *display)
 {
+    BaseType_t higher_priority_woken = pdFALSE;
+
+    flush_pending = false;
     lv_display_flush_ready(display);
-    return true;
+    if (flush_task) {
+        vTaskNotifyGiveIndexedFromISR(flush_task, LVGL_FLUSH_NOTIFY_INDEX, &higher_priority_woken);
+    }
+
+    return higher_priority_woken == pdTRUE;
+}
+
+// Blocks the rendering task until the DMA transfer is done instead of LVGL's busy-wait on the flushing flag
+static
+void flush_wait_cb(lv_display_t *display)
+{
+    while (flush_pending) {
+        if (ulTaskNotifyTakeIndexed(LVGL_FLUSH_NOTIFY_INDEX, pdTRUE, pdMS_TO_TICKS(FLUSH_TIMEOUT_MS)) == 0 && flush_pending) {
+            ESP_LOGW(TAG, "Flush not finished after %d ms", FLUSH_TIMEOUT_MS);
+        }
+    }
 }
 
 static
@@ -71,7 +134,17 @@ void my_flush_cb(lv_display_t *display, const lv_area_t *area, uint8_t *color_ma
 
     esp_lcd_panel_handle_t panel_handle = lv_display_get_user_data(display);
 
-    esp_lcd_panel_draw_bitmap(panel_handle, area->x1, area->y1, area->x2 + 1, area->y2 + 1, color_map);
+    render_stats_on_flush(area, color_map);
+
+    flush_task = xTaskGetCurrentTaskHandle();
+    flush_pending = true;
+
+    esp_err_t err = esp_lcd_panel_draw_bitmap(panel_handle, area->x1, area->y1, area->x2 + 1, area->y2 + 1, color_map);
+    if (err != ESP_OK) {
+        // No transfer was queued, so no completion ISR will follow
+        flush_pending = false;
+        lv_display_flush_ready(display);
+    }
 }
 
 // PC -> 0xFFFF1234
@@ -83,6 +156,7 @@ esp_err_t init_lvgl(lv_display_t **display)
     init_lcd_display(&panel_handle, &lcd_io_handle);
 
     lv_init();
+    mem_policy_init();
 
     static lv_color_t buf_1[FB_SIZE];
     static lv_color_t buf_2[FB_SIZE];
@@ -91,6 +165,7 @@ esp_err_t init_lvgl(lv_display_t **display)
 
     lv_display_set_user_data(*display, panel_handle);
     lv_display_set_flush_cb(*display, my_flush_cb);
+    lv_display_set_flush_wait_cb(*display, flush_wait_cb);
 
     // TODO: In case if will not enough performance, investigate another modes. Not partial, but LV_DISPLAY_RENDER_MODE_DIRECT?
     lv_display_set_buffers(*display, buf_1, buf_2, sizeof(buf_1), LV_DISPLAY_RENDER_MODE_PARTIAL);
@@ -101,17 +176,31 @@ esp_err_t init_lvgl(lv_display_t **display)
 
     esp_lcd_panel_io_register_event_callbacks(lcd_io_handle, &cbs, *display);
 
+    frame_profiler_init(*display);
+    render_stats_init(*display);
+    render_stats_set_diff_mode(RENDER_STATS_DIFF_MODE);
+    render_stats_set_heatmap(RENDER_STATS_HEATMAP);
+    alloc_tracker_init(*display);
+    alloc_tracker_set_enabled(ALLOC_TRACKER);
+
     err = esp_register_freertos_tick_hook_for_cpu(lv_tick_hook, 1);
     if (err != ESP_OK) {
         ESP_LOGE(TAG, "Failed to register lv tick hook");
     }
 
-    // TODO: Is 64kb stack & priority 15 enough?
-    xTaskCreatePinnedToCore(timer_handler, "TimerHandler", 65535, NULL, 15, NULL, 1);
+    keypad_indev = lv_indev_create();
+    lv_indev_set_type(keypad_indev, LV_INDEV_TYPE_KEYPAD);
+    lv_indev_set_read_cb(keypad_indev, button_read);
+    lv_indev_set_mode(keypad_indev, LV_INDEV_MODE_EVENT);
 
-    lv_indev_t * indev = lv_indev_create();
-    lv_indev_set_type(indev, LV_INDEV_TYPE_KEYPAD);
-    lv_indev_set_read_cb(indev, button_read);
+#if !APP_BENCHMARK_MODE
+    lv_display_add_event_cb(*display, refr_request_cb, LV_EVENT_REFR_REQUEST, NULL);
+    lv_timer_handler_set_resume_cb(timer_resume_cb, NULL);
+
+    // TODO: Is 64kb stack & priority 15 enough?
+    xTaskCreatePinnedToCore(timer_handler, "TimerHandler", 65535, NULL, 15, &lvgl_task, 1);
+    set_button_wake_task(lvgl_task);
+#endif
 
     return err;
 }
\ No newline at end of file
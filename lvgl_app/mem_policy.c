@@ -0,0 +1,218 @@
+#include "mem_policy.h"
+
+#include <stdbool.h>
+#include <string.h>
+
+#include "app_config.h"
+#include "esp_heap_caps.h"
+#include "esp_log.h"
+#include "esp_memory_utils.h"
+#include "freertos/FreeRTOS.h"
+#include "lvgl.h"
+
+static const char *TAG = "mem_policy";
+
+static const uint32_t TIER_CAPS[MEM_TIER_COUNT] = {
+    MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT,
+    MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT,
+};
+static const char *TIER_NAMES[MEM_TIER_COUNT] = {"sram", "psram"};
+
+// LVGL allocates from the LVGL task and from the game logic task
+static portMUX_TYPE s_lock = portMUX_INITIALIZER_UNLOCKED;
+static mem_tier_stats_t s_stats[MEM_TIER_COUNT];
+static char s_session_label[32] = "boot";
+
+static inline
+mem_tier_t tier_of(const void *p)
+{
+    return esp_ptr_external_ram(p) ? MEM_TIER_PSRAM : MEM_TIER_INTERNAL;
+}
+
+static
+void account(void *p, bool add)
+{
+    mem_tier_t tier = tier_of(p);
+    uint32_t size = heap_caps_get_allocated_size(p);
+
+    portENTER_CRITICAL(&s_lock);
+    mem_tier_stats_t *s = &s_stats[tier];
+    if (add) {
+        s->live_bytes += size;
+        s->allocs++;
+        if (s->live_bytes > s->peak_bytes) {
+            s->peak_bytes = s->live_bytes;
+        }
+    } else {
+        s->live_bytes -= size;
+    }
+    portEXIT_CRITICAL(&s_lock);
+}
+
+static
+void count_fallback(mem_tier_t preferred)
+{
+    portENTER_CRITICAL(&s_lock);
+    s_stats[preferred].fallbacks++;
+    portEXIT_CRITICAL(&s_lock);
+}
+
+static
+void *tier_malloc(size_t size, mem_tier_t tier)
+{
+    void *p = heap_caps_malloc(size, TIER_CAPS[tier]);
+    if (!p) {
+        p = heap_caps_malloc(size, TIER_CAPS[!tier]);
+        if (p) {
+            count_fallback(tier);
+        }
+    }
+    if (p) {
+        account(p, true);
+    }
+    return p;
+}
+
+/* Image cache draw buffers: decoded images and lv_snapshot results, large and
+ * long-lived. Freed through LVGL's default handler, i.e. lv_free_core. */
+static
+void *image_buf_malloc(size_t size, lv_color_format_t color_format)
+{
+    LV_UNUSED(color_format);
+
+    // Room for the alignment LVGL applies to the pointer afterwards, as its default does
+    size += LV_DRAW_BUF_ALIGN - 1;
+    return tier_malloc(size, size >= LV_MEM_PSRAM_THRESHOLD ? MEM_TIER_PSRAM : MEM_TIER_INTERNAL);
+}
+
+void mem_policy_init(void)
+{
+    lv_draw_buf_get_image_handlers()->buf_malloc_cb = image_buf_malloc;
+}
+
+/* LVGL stdlib hooks, see lv_mem.h. The allocation tracker wraps lv_malloc_core and
+ * lv_realloc_core at link time, which only works because they are defined here and
+ * not in the LVGL library that calls them. */
+
+void lv_mem_init(void)
+{
+}
+
+void lv_mem_deinit(void)
+{
+}
+
+lv_mem_pool_t lv_mem_add_pool(void *mem, size_t bytes)
+{
+    LV_UNUSED(mem);
+    LV_UNUSED(bytes);
+    return NULL;
+}
+
+void lv_mem_remove_pool(lv_mem_pool_t pool)
+{
+    LV_UNUSED(pool);
+}
+
+/* Everything else, whatever its size: objects, styles and text, but also layers,
+ * layer draw buffers and glyph bitmaps, which the software renderer writes every
+ * frame and which are short-lived. */
+void *lv_malloc_core(size_t size)
+{
+    return tier_malloc(size, MEM_TIER_INTERNAL);
+}
+
+void *lv_realloc_core(void *p, size_t new_size)
+{
+    if (!p) {
+        return lv_malloc_core(new_size);
+    }
+
+    // Stays in the tier of the original block unless that one is full
+    mem_tier_t tier = tier_of(p);
+    account(p, false);
+
+    void *np = heap_caps_realloc(p, new_size, TIER_CAPS[tier]);
+    if (!np && new_size > 0) {
+        np = heap_caps_realloc(p, new_size, TIER_CAPS[!tier]);
+        if (np) {
+            count_fallback(tier);
+        }
+    }
+
+    // On failure the old block is still valid and still ours
+    if (np) {
+        account(np, true);
+    } else if (new_size > 0) {
+        account(p, true);
+    }
+    return np;
+}
+
+void lv_free_core(void *p)
+{
+    if (p) {
+        account(p, false);
+        heap_caps_free(p);
+    }
+}
+
+void lv_mem_monitor_core(lv_mem_monitor_t *mon_p)
+{
+    mem_tier_stats_t stats[MEM_TIER_COUNT];
+    mem_policy_get_stats(stats);
+
+    uint32_t used = 0;
+    uint32_t free_size = 0;
+    uint32_t biggest = 0;
+    for (int tier = 0; tier < MEM_TIER_COUNT; tier++) {
+        used += stats[tier].live_bytes;
+        free_size += heap_caps_get_free_size(TIER_CAPS[tier]);
+        uint32_t largest = heap_caps_get_largest_free_block(TIER_CAPS[tier]);
+        if (largest > biggest) {
+            biggest = largest;
+        }
+    }
+
+    memset(mon_p, 0, sizeof(*mon_p));
+    mon_p->total_size = used + free_size;
+    mon_p->free_size = free_size;
+    mon_p->free_biggest_size = biggest;
+    mon_p->max_used = stats[MEM_TIER_INTERNAL].peak_bytes + stats[MEM_TIER_PSRAM].peak_bytes;
+    mon_p->used_pct = mon_p->total_size ? (uint8_t)(used * 100 / mon_p->total_size) : 0;
+}
+
+lv_result_t lv_mem_test_core(void)
+{
+    return heap_caps_check_integrity_all(true) ? LV_RESULT_OK : LV_RESULT_INVALID;
+}
+
+void mem_policy_get_stats(mem_tier_stats_t stats[MEM_TIER_COUNT])
+{
+    portENTER_CRITICAL(&s_lock);
+    memcpy(stats, s_stats, sizeof(s_stats));
+    portEXIT_CRITICAL(&s_lock);
+}
+
+void mem_policy_begin_session(const char *label)
+{
+    mem_tier_stats_t stats[MEM_TIER_COUNT];
+    mem_policy_get_stats(stats);
+
+    for (int tier = 0; tier < MEM_TIER_COUNT; tier++) {
+        ESP_LOGI(TAG, "[%s] %-5s live=%lu peak=%lu allocs=%lu fallbacks=%lu free=%zu",
+                 s_session_label, TIER_NAMES[tier], stats[tier].live_bytes, stats[tier].peak_bytes,
+                 stats[tier].allocs, stats[tier].fallbacks, heap_caps_get_free_size(TIER_CAPS[tier]));
+    }
+
+    portENTER_CRITICAL(&s_lock);
+    for (int tier = 0; tier < MEM_TIER_COUNT; tier++) {
+        s_stats[tier].peak_bytes = s_stats[tier].live_bytes;
+        s_stats[tier].allocs = 0;
+        s_stats[tier].fallbacks = 0;
+    }
+    portEXIT_CRITICAL(&s_lock);
+
+    strncpy(s_session_label, label, sizeof(s_session_label) - 1);
+    s_session_label[sizeof(s_session_label) - 1] = '\0';
+}
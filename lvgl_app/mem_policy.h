@@ -0,0 +1,50 @@
+/*
+ *		LVGL memory policy (CONFIG_LV_USE_CUSTOM_MALLOC)
+ *			- lv_malloc_core & co. on top of heap_caps instead of the fixed built-in pool
+ *			- Plain lv_malloc in internal RAM: objects, styles, text and the render
+ *			  layers and draw buffers the software renderer touches every frame
+ *			- Image cache draw buffers (decoded images, lv_snapshot) from
+ *			  LV_MEM_PSRAM_THRESHOLD on in PSRAM, they are large and long-lived
+ *			- Either tier falls back to the other when it runs out
+ *			- Live and peak bytes per tier, logged per session
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef enum {
+    MEM_TIER_INTERNAL = 0,
+    MEM_TIER_PSRAM,
+    MEM_TIER_COUNT
+} mem_tier_t;
+
+typedef struct {
+    uint32_t live_bytes;
+    uint32_t peak_bytes;        // since the session started
+    uint32_t allocs;            // since the session started
+    uint32_t fallbacks;         // requests the preferred tier could not serve
+} mem_tier_stats_t;
+
+/***************************************************************************************************
+ * Install the image draw buffer allocator, after lv_init()
+ **************************************************************************************************/
+void mem_policy_init(void);
+
+/***************************************************************************************************
+ * Bytes LVGL currently holds in each tier
+ **************************************************************************************************/
+void mem_policy_get_stats(mem_tier_stats_t stats[MEM_TIER_COUNT]);
+
+/***************************************************************************************************
+ * Log the tiers for the current session and start a new one, peaks restart from the live bytes
+ **************************************************************************************************/
+void mem_policy_begin_session(const char *label);
+
+#ifdef __cplusplus
+}
+#endif
@@ -2,33 +2,98 @@
 #include "InputRouter.hpp"
 #include "ScreenManager.hpp"
 #include "GameRegistry.hpp"
+#include "GamePreloader.hpp"
 #include "GamesConnector.hpp"
+#include "GameBenchmark.hpp"
 #include "lvgl.h"
 #include <cstdio>
 #include "esp_log.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
 
 static const char *TAG = "App";
 
 extern "C" void (*handle_input_event)(uint32_t key);
 
 static bool initialized = false;
+static TaskHandle_t logicTask = nullptr;
+static SemaphoreHandle_t simulationMutex = nullptr;
 
 void process_game_logic(void) {
+    // Games call LVGL from this core while the LVGL task and draw threads run on the other
+    lv_lock();
+
     if (!initialized) {
         ESP_LOGI(TAG, "Initializing game logic");
 
+        logicTask = xTaskGetCurrentTaskHandle();
+        simulationMutex = xSemaphoreCreateMutex();
+        GamePreloader::instance().start();
         ScreenManager::instance().init();
 
         initialized = true;
     }
 
+    Game* currentGame = nullptr;
     if (ScreenManager::instance().state() == ScreenManager::State::GAME) {
-        Game* currentGame = ScreenManager::instance().getCurrentGame();
-        if (currentGame) {
-            ESP_LOGI(TAG, "Calling game update()");
-            currentGame->update();
-        } else {
+        currentGame = ScreenManager::instance().getCurrentGame();
+        if (!currentGame) {
             ESP_LOGI(TAG, "No active game to update");
         }
     }
+
+    if (currentGame && currentGame->isPipelined()) {
+        // The game can't be deleted before the mutex is released, see ScreenManager::switchToMenu()
+        game_simulation_lock();
+        lv_unlock();
+        currentGame->simulate();
+        game_simulation_unlock();
+        return;
+    }
+
+    if (currentGame) {
+        ESP_LOGI(TAG, "Calling game update()");
+        currentGame->update();
+    }
+
+    lv_unlock();
+}
+
+// Menu and event-driven games are fully handled on the LVGL task
+bool game_logic_is_idle(void) {
+    if (!initialized) {
+        return false;
+    }
+
+    if (ScreenManager::instance().state() != ScreenManager::State::GAME) {
+        return true;
+    }
+
+    Game* currentGame = ScreenManager::instance().getCurrentGame();
+    return !currentGame || currentGame->isEventDriven();
+}
+
+void wake_game_logic(void) {
+    if (logicTask) {
+        xTaskNotifyGive(logicTask);
+    }
+}
+
+// No mutex before the logic loop starts (benchmark mode), nothing simulates concurrently then
+void game_simulation_lock(void) {
+    if (simulationMutex) {
+        xSemaphoreTake(simulationMutex, portMAX_DELAY);
+    }
+}
+
+void game_simulation_unlock(void) {
+    if (simulationMutex) {
+        xSemaphoreGive(simulationMutex);
+    }
+}
+
+void run_game_benchmark(void) {
+    ESP_LOGI(TAG, "Starting game benchmark");
+    GameBenchmark::instance().start();
 }
\ No newline at end of file
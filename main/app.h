@@ -1,6 +1,7 @@
 #pragma once
 
 #include <inttypes.h>
+#include <stdbool.h>
 
 #ifdef __cplusplus
 extern "C" {
@@ -8,6 +9,13 @@ extern "C" {
 
 extern void (*handle_input_event)(uint32_t key);
 void process_game_logic(void);
+bool game_logic_is_idle(void);
+void wake_game_logic(void);
+void run_game_benchmark(void);
+
+// Held while a pipelined game simulates, take it after lv_lock() to delete a game
+void game_simulation_lock(void);
+void game_simulation_unlock(void);
 
 #ifdef __cplusplus
 }
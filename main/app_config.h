@@ -51,3 +51,63 @@
 #define LCD_FREQUENCY_HZ 	10000000
 
 #define DMA_BURST_SIZE		64
+
+/* TASK NOTIFICATION INDICES */
+// Index 0 belongs to LVGL (LV_USE_FREERTOS_TASK_NOTIFY), it consumes any notification while
+// waiting for its own sync objects, so wake-ups of the LVGL task use separate slots.
+#define LVGL_WAKE_NOTIFY_INDEX		1	// button edge, invalidation, new timer
+#define LVGL_FLUSH_NOTIFY_INDEX		2	// panel DMA transfer finished
+
+/* DIAGNOSTICS */
+#define RENDER_STATS_DIFF_MODE		0	// Compare every flushed area against a PSRAM shadow frame
+#define RENDER_STATS_HEATMAP		0	// Tint recently redrawn regions on screen
+#define ALLOC_TRACKER			0	// Per frame allocation counters and top call sites per session
+
+/* MEMORY */
+#define LV_MEM_PSRAM_THRESHOLD	1024	// Decoded image and snapshot buffers from this size on go to PSRAM, other LVGL memory stays internal
+
+/* SCREEN CACHE */
+#define SCREEN_SNAPSHOTS		1	// Full screen images in PSRAM for transitions and the idle menu
+#define TRANSITION_MS			250
+#define MENU_SNAPSHOT_DELAY_MS	600	// Settle time after the last menu key before it is captured
+
+/* TEARDOWN */
+#define TEARDOWN_BUDGET_US		2000	// Object deletion time per LVGL cycle after leaving a game
+#define TEARDOWN_PERIOD_MS		10
+
+/* GAME PRELOADING */
+#define PRELOAD_TASK_PRIORITY	1		// Core 0, same as app_main which sleeps while the menu is shown
+#define PRELOAD_SETTLE_MS		150		// Selection must stay put this long before a preload starts
+#define PRELOAD_MAX_BYTES		(48 * 1024)	// Largest asset staging done speculatively
+#define PRELOAD_MIN_FREE_DMA	(32 * 1024)	// DMA capable heap left free after staging
+
+/* ATTRACT MODE */
+#define ATTRACT_IDLE_MS			30000	// Menu idle time before a game starts playing itself, 0 - off
+#define ATTRACT_GAME			"Tetris"
+#define ATTRACT_STEP_MS			100		// One autoplayer move: rotate, shift or drop
+#define ATTRACT_RESTART_MS		3000	// Game over shown this long before the demo starts over
+
+/* 2048 */
+#define G2048_SEARCH_PRIORITY	1		// Core 0, the logic loop sleeps while 2048 waits for keys
+#define G2048_SEARCH_MS			80		// Hint search budget, deeper passes are dropped at the deadline
+#define G2048_MAX_DEPTH			6		// Player moves searched ahead at most
+#define G2048_TT_BITS			15		// Transposition table of 2^n boards, 16 bytes each in PSRAM
+#define G2048_SLIDE_MS			90		// Tile slide, a key during the animation finishes it at once
+#define G2048_POP_MS			110		// Merge pop and new tile growth after the slide
+
+/* MINESWEEPER */
+#define MINES_GENERATOR_PRIORITY	1	// Core 0, the logic loop sleeps while Minesweeper waits for keys
+#define MINES_NO_GUESS_MS		1000	// Search for a board solvable without guessing, then a random one is used
+
+/* BENCHMARK */
+#define APP_BENCHMARK_MODE		0	// Run every game on a virtual clock instead of the menu, JSON results on UART
+#define BENCH_FRAMES			600
+#define BENCH_FRAME_MS			33
+#define BENCH_INPUT_INTERVAL	5	// Frames between two injected keys
+#define BENCH_RANDOM_INPUT		1	// 0 - cycle through the built-in key script
+#define BENCH_SEED				12345
+#define BENCH_HEADLESS_FLUSH	1	// Skip the panel transfer, measures rendering only
+#define BENCH_MICRO				1	// Run the driver/draw microbenchmarks before the games
+#define BENCH_AI_PIECES			2000	// Tetris autoplayer pieces placed without rendering, 0 - off
+#define BENCH_2048_MOVES		200		// 2048 moves chosen by the hint search without rendering, 0 - off
+#define BENCH_MINES_BOARDS		500		// Expert Minesweeper boards checked by the no-guess solver, 0 - off
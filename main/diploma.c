@@ -4,6 +4,8 @@
 #include "lvgl_init.h"
 #include "hardware_info.h"
 #include "app.h"
+#include "frame_profiler.h"
+#include "alloc_tracker.h"
 
 #define TAG         "DIPLOM"
 
@@ -15,8 +17,24 @@ void app_main(void)
     print_hardware_info();
 
     init_lvgl(&display);
+
+#if APP_BENCHMARK_MODE
+    run_game_benchmark();
+    return;
+#endif
+
     while (1) {
-        vTaskDelay(pdMS_TO_TICKS(33));   // TODO: Calculate 33 - process_game_logic delay to assume stable 30 FPS (?)
+        if (game_logic_is_idle()) {
+            // Woken by ScreenManager when a periodically updated game starts
+            ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        } else {
+            vTaskDelay(pdMS_TO_TICKS(33));   // TODO: Calculate 33 - process_game_logic delay to assume stable 30 FPS (?)
+        }
+        // process_game_logic() takes the LVGL lock itself, pipelined games simulate without it
+        frame_profiler_game_begin();
+        alloc_scope_t scope = alloc_tracker_enter(ALLOC_SCOPE_GAME);
         process_game_logic();
+        alloc_tracker_leave(scope);
+        frame_profiler_game_end();
     }
 }
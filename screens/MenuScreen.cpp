@@ -1,7 +1,9 @@
 #include "MenuScreen.hpp"
+#include "GamePreloader.hpp"
 #include "esp_log.h"
 #include "lvgl.h"
 #include "lvgl_helper.hpp"
+#include "app_config.h"
 #include <cstdio>
 
 #define TAG "MenuScreen"
@@ -30,14 +32,10 @@ void MenuScreen::createUI() {
     lv_obj_set_scroll_dir(list_, LV_DIR_VER);
     lv_obj_set_scrollbar_mode(list_, LV_SCROLLBAR_MODE_AUTO);
 
-    lv_obj_set_layout(list_, LV_LAYOUT_FLEX);
-    lv_obj_set_flex_flow(list_, LV_FLEX_FLOW_COLUMN);
-    lv_obj_set_style_pad_row(list_, 8, 0);
-
     lv_obj_set_style_pad_left(list_, 20, 0);
     lv_obj_set_style_pad_right(list_, 20, 0);
 
-    lv_obj_set_size(list_, 280, 300);
+    lv_obj_set_size(list_, LIST_WIDTH, LIST_HEIGHT);
     lv_obj_align(list_, LV_ALIGN_CENTER, 0, 20);
 
     ESP_LOGI(TAG, "Creating menu UI, games count: %zu\n", games_.size());
@@ -50,51 +48,151 @@ void MenuScreen::createUI() {
         lv_obj_align(lbl, LV_ALIGN_CENTER, 0, 0);
     }
     else {
-        for (size_t i = 0; i < games_.size() && i < 10; ++i) {
-            items_[i] = lv_btn_create(list_);
-            applyCleanStyle(items_[i]);
-            lv_obj_set_style_bg_color(items_[i], lv_color_make(200, 200, 200), 0);
-            lv_obj_set_style_bg_opa(items_[i], LV_OPA_COVER, 0);
-
-            lv_obj_set_width(items_[i], lv_pct(100));
-            lv_obj_set_height(items_[i], 50);
-
-            auto *lbl = lv_label_create(items_[i]);
-            applyCleanStyle(lbl);
-            lv_label_set_text(lbl, games_[i].name.c_str());
-            lv_obj_center(lbl);
-        }
-        updateSelection();
+        createRows();
+        bindWindow();
     }
 
     hint_ = lv_label_create(screen_);
     applyCleanStyle(hint_);
     lv_label_set_text(hint_, "UP/DOWN: Navigate\nENTER: Select");
     lv_obj_align(hint_, LV_ALIGN_BOTTOM_MID, 0, -20);
+
+    createCachedScreen();
+}
+
+void MenuScreen::createCachedScreen() {
+    if (!SCREEN_SNAPSHOTS) return;
+
+    cachedScreen_ = createCleanObject(nullptr);
+    // Bound once the first snapshot exists, LVGL rejects an empty buffer
+    cachedImage_ = snapshot_.createView(cachedScreen_);
+
+    snapshotTimer_ = lv_timer_create(snapshotTimerCallback, MENU_SNAPSHOT_DELAY_MS, this);
+    lv_timer_pause(snapshotTimer_);
 }
 
 
 
 void MenuScreen::show() {
-    lv_scr_load(screen_);
+    if (snapshot_.valid()) {
+        lv_scr_load(cachedScreen_);
+        showingCached_ = true;
+    } else {
+        showLive();
+    }
+    if (!games_.empty()) {
+        GamePreloader::instance().request(&games_[selectedIndex_]);
+    }
 }
 
 void MenuScreen::hide() {
+    if (snapshotTimer_) {
+        lv_timer_pause(snapshotTimer_);
+    }
+}
+
+void MenuScreen::showLive() {
+    lv_scr_load(screen_);
+    showingCached_ = false;
+    if (!snapshot_.valid()) {
+        scheduleSnapshot();
+    }
+}
+
+void MenuScreen::scheduleSnapshot() {
+    if (!snapshotTimer_) return;
+
+    lv_timer_reset(snapshotTimer_);
+    lv_timer_resume(snapshotTimer_);
+}
+
+// Fires once the selection and its scroll animation have settled
+void MenuScreen::snapshotTimerCallback(lv_timer_t* timer) {
+    auto* menu = static_cast<MenuScreen*>(lv_timer_get_user_data(timer));
+    lv_timer_pause(timer);
+    if (!menu->snapshot_.valid() && lv_screen_active() == menu->screen_) {
+        if (menu->snapshot_.capture(menu->screen_)) {
+            menu->snapshot_.bindView(menu->cachedImage_);
+        }
+    }
+}
+
+void MenuScreen::createRows() {
+    // Invisible marker at the end of the last item gives the list its full scroll height
+    lv_obj_t* end = createCleanObject(list_);
+    lv_obj_remove_style_all(end);
+    lv_obj_set_size(end, 1, 1);
+    lv_obj_set_y(end, static_cast<int32_t>(games_.size() - 1) * ROW_PITCH + ROW_HEIGHT - 1);
+
+    for (int row = 0; row < ROW_POOL; ++row) {
+        rows_[row] = lv_btn_create(list_);
+        applyCleanStyle(rows_[row]);
+        lv_obj_set_style_bg_opa(rows_[row], LV_OPA_COVER, 0);
+        lv_obj_set_width(rows_[row], lv_pct(100));
+        lv_obj_set_height(rows_[row], ROW_HEIGHT);
+        lv_obj_add_flag(rows_[row], LV_OBJ_FLAG_HIDDEN);
+
+        rowLabels_[row] = lv_label_create(rows_[row]);
+        applyCleanStyle(rowLabels_[row]);
+        lv_obj_center(rowLabels_[row]);
+
+        rowItems_[row] = -1;
+    }
+}
+
+// Makes sure every item in the window around firstVisible_ is bound to its row.
+// Scrolling by one item rebinds exactly one row.
+void MenuScreen::bindWindow() {
+    int count = static_cast<int>(games_.size());
+    int first = firstVisible_ - 1;
+
+    for (int item = first; item < first + ROW_POOL; ++item) {
+        if (item < 0) {
+            continue;
+        }
+        int row = item % ROW_POOL;
+        if (item >= count) {
+            if (rowItems_[row] != -1) {
+                lv_obj_add_flag(rows_[row], LV_OBJ_FLAG_HIDDEN);
+                rowItems_[row] = -1;
+            }
+            continue;
+        }
+        if (rowItems_[row] != item) {
+            bindRow(row, item);
+        }
+    }
+}
+
+void MenuScreen::bindRow(int row, int item) {
+    rowItems_[row] = item;
+    lv_obj_set_y(rows_[row], item * ROW_PITCH);
+    // Registry entries live for the whole runtime, no copy of the name is needed
+    lv_label_set_text_static(rowLabels_[row], games_[item].name.c_str());
+    styleRow(row, item == selectedIndex_);
+    lv_obj_clear_flag(rows_[row], LV_OBJ_FLAG_HIDDEN);
+}
+
+void MenuScreen::styleRow(int row, bool selected) {
+    lv_obj_set_style_bg_color(rows_[row], selected ? lv_color_make(255, 128, 0) : lv_color_make(32, 32, 32), 0);
 }
 
 void MenuScreen::handleInput(uint32_t key) {
     if (games_.empty()) return;
 
-    bool changed = false;
+    // Any key brings back the real menu, the image cannot scroll or highlight
+    if (showingCached_) {
+        showLive();
+    }
+
+    int previousIndex = selectedIndex_;
     switch (key) {
         case LV_KEY_UP:
-            if (selectedIndex_ > 0) { selectedIndex_--; changed = true; }
+            if (selectedIndex_ > 0) { selectedIndex_--; }
             ESP_LOGI(TAG, "Menu UP pressed, current index: %d\n", selectedIndex_);
             break;
         case LV_KEY_DOWN:
-            if (selectedIndex_ < static_cast<int>(games_.size()) - 1 && selectedIndex_ < 9) {
-                selectedIndex_++; changed = true;
-            }
+            if (selectedIndex_ < static_cast<int>(games_.size()) - 1) { selectedIndex_++; }
             ESP_LOGI(TAG, "Menu DOWN pressed, current index: %d\n", selectedIndex_);
             break;
         case LV_KEY_ENTER:
@@ -106,20 +204,36 @@ void MenuScreen::handleInput(uint32_t key) {
         default:
             break;
     }
-    if (changed) {
-        updateSelection();
+    if (selectedIndex_ != previousIndex) {
+        updateSelection(previousIndex);
+        snapshot_.invalidate();
+        scheduleSnapshot();
+        GamePreloader::instance().request(&games_[selectedIndex_]);
     }
 }
 
-void MenuScreen::updateSelection() {
-    lv_obj_scroll_to_view(items_[selectedIndex_], LV_ANIM_ON);
+void MenuScreen::updateSelection(int previousIndex) {
+    int first = firstVisible_;
+    if (selectedIndex_ < first) {
+        first = selectedIndex_;
+    } else if (selectedIndex_ >= first + FULL_ROWS) {
+        first = selectedIndex_ - FULL_ROWS + 1;
+    }
 
-    for (int i = 0; i < static_cast<int>(games_.size()) && i < 10; ++i) {
-        if (i == selectedIndex_) {
-            lv_obj_set_style_bg_color(items_[i], lv_color_make(255, 128, 0), 0);
-        } else {
-            lv_obj_set_style_bg_color(items_[i], lv_color_make(32, 32, 32), 0);
-        }
+    if (first != firstVisible_) {
+        firstVisible_ = first;
+        bindWindow();
+        lv_obj_scroll_to_y(list_, firstVisible_ * ROW_PITCH, LV_ANIM_ON);
+    }
+
+    // Only the two rows whose state changed are restyled
+    int previousRow = previousIndex % ROW_POOL;
+    if (rowItems_[previousRow] == previousIndex) {
+        styleRow(previousRow, false);
+    }
+    int selectedRow = selectedIndex_ % ROW_POOL;
+    if (rowItems_[selectedRow] == selectedIndex_) {
+        styleRow(selectedRow, true);
     }
 }
 
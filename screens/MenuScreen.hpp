@@ -3,6 +3,7 @@
 #include "Screen.hpp"
 #include "GameRegistry.hpp"
 #include "InputRouter.hpp"
+#include "ScreenSnapshot.hpp"
 #include "lvgl.h"
 #include <functional>
 
@@ -24,16 +25,49 @@ public:
     void setGameSelectedCallback(GameSelectedCallback callback);
 
 private:
+    // Only a window of rows exists, recycled as a ring: item i is always shown by
+    // row i % ROW_POOL. One extra row above and below the visible part keeps the
+    // scroll animation from revealing a row that was just rebound.
+    static const int LIST_WIDTH = 280;
+    static const int LIST_HEIGHT = 300;
+    static const int ROW_HEIGHT = 50;
+    static const int ROW_SPACING = 8;
+    static const int ROW_PITCH = ROW_HEIGHT + ROW_SPACING;
+    static const int FULL_ROWS = (LIST_HEIGHT + ROW_SPACING) / ROW_PITCH;
+    static const int VISIBLE_ROWS = (LIST_HEIGHT + ROW_PITCH - 1) / ROW_PITCH;
+    static const int ROW_POOL = VISIBLE_ROWS + 2;
+
     void createUI();
-    void updateSelection();
+    void createRows();
+    void updateSelection(int previousIndex);
+    void bindWindow();
+    void bindRow(int row, int item);
+    void styleRow(int row, bool selected);
+
+    // The menu only changes on input. Once the selection has settled it is captured,
+    // and coming back from a game shows that image until the next key instead of
+    // rendering the whole tree again.
+    void createCachedScreen();
+    void scheduleSnapshot();
+    void showLive();
+    static void snapshotTimerCallback(lv_timer_t* timer);
     
     lv_obj_t* screen_ = nullptr;
     lv_obj_t* list_   = nullptr;
     lv_obj_t* title_  = nullptr;
     lv_obj_t* hint_   = nullptr;
-    lv_obj_t* items_[10] = {nullptr};
+    lv_obj_t* rows_[ROW_POOL] = {nullptr};
+    lv_obj_t* rowLabels_[ROW_POOL] = {nullptr};
+    int rowItems_[ROW_POOL];
+
+    ScreenSnapshot snapshot_;
+    lv_obj_t* cachedScreen_ = nullptr;
+    lv_obj_t* cachedImage_ = nullptr;
+    lv_timer_t* snapshotTimer_ = nullptr;
+    bool showingCached_ = false;
     
     int selectedIndex_ = 0;
+    int firstVisible_ = 0;
     GameSelectedCallback gameSelectedCallback_ = nullptr;
     const std::vector<GameFactory>& games_;
 };
\ No newline at end of file
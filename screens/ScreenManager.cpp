@@ -1,4 +1,12 @@
 #include "ScreenManager.hpp"
+#include "ProfilerOverlay.hpp"
+#include "GamePreloader.hpp"
+#include "ScreenTransition.hpp"
+#include "render_stats.h"
+#include "alloc_tracker.h"
+#include "mem_policy.h"
+#include "app.h"
+#include "app_config.h"
 #include <cstdio>
 #include "esp_log.h"
 
@@ -29,6 +37,10 @@ void ScreenManager::init() {
             handleInput(key);
         });
         
+        if (ATTRACT_IDLE_MS > 0) {
+            attractTimer_ = lv_timer_create(attractTimerCallback, ATTRACT_IDLE_MS, this);
+        }
+
         initialized_ = true;
         ESP_LOGI(TAG, "ScreenManager initialized");
     }
@@ -40,26 +52,57 @@ void ScreenManager::switchToMenu() {
     ESP_LOGI(TAG, "Switching to Menu");
     
     if (currentGame_) {
+        // The game screen is captured before anything is deleted and slides away over the menu
+        ScreenTransition::instance().slideOut(lv_screen_active());
+
+        // stop() hands the game screen to DeferredDeleter, the menu is shown meanwhile
         Game* gameToDelete = currentGame_.release();
         lv_async_call([](void* p) {
             Game* game = static_cast<Game*>(p);
             game->stop();
+            // A pipelined game may still be inside simulate() on the logic task
+            game_simulation_lock();
             delete game;
+            game_simulation_unlock();
         }, gameToDelete);
     }
     
+    attract_ = false;
+    if (attractTimer_) {
+        lv_timer_reset(attractTimer_);
+        lv_timer_resume(attractTimer_);
+    }
+
+    render_stats_begin_session("Menu");
+    alloc_tracker_begin_session("Menu");
+    mem_policy_begin_session("Menu");
     menuScreen_.show();
     state_ = State::MENU;
 }
 
-void ScreenManager::switchToGame(const GameFactory& gameFactory) {
+void ScreenManager::switchToGame(const GameFactory& gameFactory, bool autoplay) {
     ESP_LOGI(TAG, "Switching to Game: %s", gameFactory.name.c_str());
     
-    currentGame_ = gameFactory.create();
+    render_stats_begin_session(gameFactory.name.c_str());
+    alloc_tracker_begin_session(gameFactory.name.c_str());
+    mem_policy_begin_session(gameFactory.name.c_str());
+    menuScreen_.hide();
+    currentGame_ = GamePreloader::instance().take(gameFactory);
+    if (!currentGame_) {
+        currentGame_ = gameFactory.create();
+    }
+    
+    if (attractTimer_) {
+        lv_timer_pause(attractTimer_);
+    }
     
     if (currentGame_) {
+        attract_ = autoplay && currentGame_->setAutoplay(true);
         currentGame_->run();
         state_ = State::GAME;
+        if (!currentGame_->isEventDriven()) {
+            wake_game_logic();
+        }
     } else {
         ESP_LOGE(TAG, "Failed to create game");
         switchToMenu();
@@ -69,6 +112,23 @@ void ScreenManager::switchToGame(const GameFactory& gameFactory) {
 void ScreenManager::handleInput(uint32_t key) {
     ESP_LOGI(TAG, "ScreenManager handling key: %lu, state: %d", key, (int)state_);
 
+    if (attractTimer_) {
+        lv_timer_reset(attractTimer_);
+    }
+
+    // Any key ends the demo and is not passed on
+    if (state_ == State::GAME && attract_) {
+        ESP_LOGI(TAG, "Attract mode ended by key");
+        switchToMenu();
+        return;
+    }
+
+    // LEFT+RIGHT chord, see gpio_driver.c
+    if (key == LV_KEY_HOME) {
+        ProfilerOverlay::instance().toggle();
+        return;
+    }
+
     if (state_ == State::GAME && (key == LV_KEY_ESC || key == LV_KEY_BACKSPACE)) {
         ESP_LOGI(TAG, "Exit from game requested by ScreenManager");
         switchToMenu();
@@ -81,5 +141,26 @@ void ScreenManager::handleInput(uint32_t key) {
     } else if (state_ == State::GAME && currentGame_) {
         ESP_LOGI(TAG, "Passing key to Game: %lu", key);
         currentGame_->handleKey(key);
+        if (currentGame_->isEventDriven()) {
+            currentGame_->update();
+        }
     }
-}
\ No newline at end of file
+}
+void ScreenManager::startAttract() {
+    for (const auto& factory : GameRegistry::instance().available()) {
+        if (factory.name == ATTRACT_GAME) {
+            ESP_LOGI(TAG, "Menu idle, starting attract mode");
+            switchToGame(factory, true);
+            return;
+        }
+    }
+    ESP_LOGW(TAG, "Attract game %s is not registered", ATTRACT_GAME);
+    lv_timer_pause(attractTimer_);
+}
+
+void ScreenManager::attractTimerCallback(lv_timer_t* timer) {
+    auto* manager = static_cast<ScreenManager*>(lv_timer_get_user_data(timer));
+    if (manager->state_ == State::MENU) {
+        manager->startAttract();
+    }
+}
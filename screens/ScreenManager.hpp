@@ -17,7 +17,7 @@ public:
     
     void init();
     void switchToMenu();
-    void switchToGame(const GameFactory& gameFactory);
+    void switchToGame(const GameFactory& gameFactory, bool autoplay = false);
     void handleInput(uint32_t key);
 
     State state() const { return state_; }
@@ -25,12 +25,18 @@ public:
 private:
     ScreenManager();
     ~ScreenManager() = default;
+
+    // Attract mode: ATTRACT_GAME plays itself after ATTRACT_IDLE_MS without menu input
+    void startAttract();
+    static void attractTimerCallback(lv_timer_t* timer);
     
     State state_ = State::MENU;
     
     MenuScreen menuScreen_;
     std::unique_ptr<Game> currentGame_;
     bool initialized_ = false;
+    lv_timer_t* attractTimer_ = nullptr;
+    bool attract_ = false;
     
     // Singleton
     static ScreenManager* instance_;
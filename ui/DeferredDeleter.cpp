@@ -0,0 +1,101 @@
+#include "DeferredDeleter.hpp"
+#include "app_config.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+
+static const char *TAG = "DeferredDeleter";
+
+static uint32_t countObjects(lv_obj_t* obj) {
+    uint32_t count = 1;
+    uint32_t childCount = lv_obj_get_child_count(obj);
+    for (uint32_t i = 0; i < childCount; i++) {
+        count += countObjects(lv_obj_get_child(obj, i));
+    }
+    return count;
+}
+
+DeferredDeleter& DeferredDeleter::instance() {
+    static DeferredDeleter inst;
+    return inst;
+}
+
+void DeferredDeleter::enqueue(lv_obj_t* root) {
+    if (!root) return;
+
+    // Deleting the visible screen piece by piece would show up on the panel
+    if (root == lv_screen_active()) {
+        ESP_LOGW(TAG, "Active screen deleted immediately");
+        lv_obj_delete(root);
+        return;
+    }
+
+    uint32_t objects = countObjects(root);
+    if (queue_.empty()) {
+        batchObjects_ = 0;
+        batchCycles_ = 0;
+        batchStartUs_ = esp_timer_get_time();
+    }
+    queue_.push_back(root);
+    pendingObjects_ += objects;
+    batchObjects_ += objects;
+
+    // Paused while idle so it never wakes the LVGL task on its own
+    if (!timer_) {
+        timer_ = lv_timer_create(timerCallback, TEARDOWN_PERIOD_MS, this);
+    } else {
+        lv_timer_resume(timer_);
+    }
+}
+
+void DeferredDeleter::drain() {
+    for (lv_obj_t* root : queue_) {
+        lv_obj_delete(root);
+    }
+    queue_.clear();
+    pendingObjects_ = 0;
+    finishBatch();
+}
+
+void DeferredDeleter::step() {
+    int64_t start = esp_timer_get_time();
+    batchCycles_++;
+
+    while (!queue_.empty()) {
+        // Deepest last descendant, removing it never shifts a child list
+        lv_obj_t* victim = queue_.front();
+        while (lv_obj_get_child_count(victim) > 0) {
+            victim = lv_obj_get_child(victim, -1);
+        }
+        if (victim == queue_.front()) {
+            queue_.pop_front();
+        }
+        lv_obj_delete(victim);
+        if (pendingObjects_ > 0) {
+            pendingObjects_--;
+        }
+
+        if (esp_timer_get_time() - start >= TEARDOWN_BUDGET_US) {
+            break;
+        }
+    }
+
+    if (queue_.empty()) {
+        finishBatch();
+    }
+}
+
+void DeferredDeleter::finishBatch() {
+    if (timer_) {
+        lv_timer_pause(timer_);
+    }
+    if (batchObjects_ > 0) {
+        ESP_LOGI(TAG, "Deleted %lu objects in %lu cycles over %lld ms", batchObjects_, batchCycles_,
+                 (esp_timer_get_time() - batchStartUs_) / 1000);
+    }
+    batchObjects_ = 0;
+    batchCycles_ = 0;
+}
+
+void DeferredDeleter::timerCallback(lv_timer_t* timer) {
+    static_cast<DeferredDeleter*>(lv_timer_get_user_data(timer))->step();
+}
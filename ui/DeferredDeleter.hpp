@@ -0,0 +1,43 @@
+#pragma once
+
+#include "lvgl.h"
+#include <cstdint>
+#include <deque>
+
+// Deletes object trees a few objects at a time from an LVGL timer, at most
+// TEARDOWN_BUDGET_US per cycle, so leaving a game with hundreds of cells does
+// not stall the first frames of the menu. Objects are deleted leaf first from
+// the end of each child list, which keeps every single deletion cheap.
+//
+// Queued trees must not be the active screen and nothing may reference them
+// anymore: timers and animations with callbacks into the owner are deleted
+// by the owner before enqueue().
+class DeferredDeleter {
+public:
+    static DeferredDeleter& instance();
+
+    void enqueue(lv_obj_t* root);
+
+    // Delete everything still queued right away
+    void drain();
+
+    // Objects queued but not deleted yet
+    uint32_t pendingObjects() const { return pendingObjects_; }
+
+private:
+    DeferredDeleter() = default;
+
+    void step();
+    void finishBatch();
+
+    static void timerCallback(lv_timer_t* timer);
+
+    std::deque<lv_obj_t*> queue_;
+    lv_timer_t* timer_ = nullptr;
+    uint32_t pendingObjects_ = 0;
+
+    // Current batch, from the first enqueue until the queue runs empty
+    uint32_t batchObjects_ = 0;
+    uint32_t batchCycles_ = 0;
+    int64_t batchStartUs_ = 0;
+};
@@ -0,0 +1,77 @@
+#include "OverlayService.hpp"
+#include "lvgl_helper.hpp"
+#include "app_config.h"
+#include "esp_log.h"
+
+static const char *TAG = "OverlayService";
+
+OverlayService& OverlayService::instance() {
+    static OverlayService inst;
+    return inst;
+}
+
+lv_obj_t* OverlayService::show(lv_obj_t* screen, lv_opa_t dim) {
+    hide();
+
+    if (SCREEN_SNAPSHOTS && snapshot_.capture(screen)) {
+        darken(dim);
+
+        // Children that are already hidden stay hidden after hide()
+        uint32_t childCount = lv_obj_get_child_count(screen);
+        hidden_.reserve(childCount);
+        for (uint32_t i = 0; i < childCount; i++) {
+            lv_obj_t* child = lv_obj_get_child(screen, i);
+            if (!lv_obj_has_flag(child, LV_OBJ_FLAG_HIDDEN)) {
+                lv_obj_add_flag(child, LV_OBJ_FLAG_HIDDEN);
+                hidden_.push_back(child);
+            }
+        }
+
+        root_ = snapshot_.createView(screen);
+    } else {
+        ESP_LOGW(TAG, "No snapshot, overlay blended over the live scene");
+        root_ = createCleanObject(screen);
+        lv_obj_set_style_bg_color(root_, lv_color_make(0, 0, 0), 0);
+        lv_obj_set_style_bg_opa(root_, dim, 0);
+    }
+
+    lv_obj_set_size(root_, DISP_WIDTH, DISP_HEIGHT);
+    lv_obj_set_pos(root_, 0, 0);
+    // The screen is deleted with the overlay still up when the game is left
+    lv_obj_add_event_cb(root_, deleteCallback, LV_EVENT_DELETE, this);
+    return root_;
+}
+
+void OverlayService::hide() {
+    if (!root_) return;
+
+    for (lv_obj_t* obj : hidden_) {
+        lv_obj_clear_flag(obj, LV_OBJ_FLAG_HIDDEN);
+    }
+    lv_obj_delete(root_);
+}
+
+// Blend toward black once, in place, with the same weight the layer had
+void OverlayService::darken(lv_opa_t dim) {
+    lv_draw_buf_t* buf = snapshot_.buffer();
+    uint32_t keep = 256 - (dim * 256 + 127) / 255;
+
+    for (uint32_t y = 0; y < buf->header.h; y++) {
+        uint16_t* px = reinterpret_cast<uint16_t*>(buf->data + y * buf->header.stride);
+        for (uint32_t x = 0; x < buf->header.w; x++) {
+            uint32_t c = px[x];
+            uint32_t r = (((c >> 11) & 0x1F) * keep) >> 8;
+            uint32_t g = (((c >> 5) & 0x3F) * keep) >> 8;
+            uint32_t b = ((c & 0x1F) * keep) >> 8;
+            px[x] = static_cast<uint16_t>((r << 11) | (g << 5) | b);
+        }
+    }
+
+    snapshot_.dropCached();
+}
+
+void OverlayService::deleteCallback(lv_event_t* e) {
+    auto* service = static_cast<OverlayService*>(lv_event_get_user_data(e));
+    service->root_ = nullptr;
+    service->hidden_.clear();
+}
@@ -0,0 +1,34 @@
+#pragma once
+
+#include "lvgl.h"
+#include "ScreenSnapshot.hpp"
+#include <vector>
+
+// Game-over and pause overlays. Instead of a translucent layer blended over the
+// live game every frame, the scene is captured once, darkened in place and shown
+// as one opaque image while the game objects underneath are hidden. A frame with
+// the overlay up costs a blit plus whatever the overlay itself contains.
+class OverlayService {
+public:
+    static OverlayService& instance();
+
+    // Parent for the overlay content, covering the whole screen. Falls back to a
+    // plain dimmed layer over the live scene when no snapshot could be taken.
+    lv_obj_t* show(lv_obj_t* screen, lv_opa_t dim);
+
+    // Deletes the overlay and its content, the game objects become visible again
+    void hide();
+
+    bool visible() const { return root_ != nullptr; }
+
+private:
+    OverlayService() = default;
+
+    void darken(lv_opa_t dim);
+
+    static void deleteCallback(lv_event_t* e);
+
+    ScreenSnapshot snapshot_;
+    lv_obj_t* root_ = nullptr;
+    std::vector<lv_obj_t*> hidden_;
+};
@@ -0,0 +1,133 @@
+#include "ProfilerOverlay.hpp"
+#include "lvgl_helper.hpp"
+#include "DeferredDeleter.hpp"
+#include "app_config.h"
+#include "esp_log.h"
+#include <cstdio>
+
+static const char *TAG = "ProfilerOverlay";
+
+// Chart values are in 0.1 ms, full scale is one 30 FPS frame
+static const int32_t CHART_MAX = 333;
+
+ProfilerOverlay& ProfilerOverlay::instance() {
+    static ProfilerOverlay inst;
+    return inst;
+}
+
+void ProfilerOverlay::toggle() {
+    if (visible()) {
+        destroy();
+        frame_profiler_set_uart_report(false);
+        ESP_LOGI(TAG, "Profiler overlay hidden");
+    } else {
+        create();
+        frame_profiler_set_uart_report(true);
+        ESP_LOGI(TAG, "Profiler overlay shown");
+    }
+}
+
+void ProfilerOverlay::create() {
+    panel_ = createCleanObject(lv_layer_top());
+    lv_obj_set_size(panel_, DISP_WIDTH, PANEL_HEIGHT);
+    lv_obj_align(panel_, LV_ALIGN_BOTTOM_MID, 0, 0);
+    lv_obj_set_style_bg_color(panel_, lv_color_make(0, 0, 0), 0);
+    lv_obj_set_style_bg_opa(panel_, LV_OPA_COVER, 0);
+    lv_obj_set_style_border_width(panel_, 0, 0);
+    lv_obj_set_style_radius(panel_, 0, 0);
+
+    statsLabel_ = createLabel(panel_, "", LV_ALIGN_TOP_LEFT, 4, 2);
+    lv_obj_set_style_text_color(statsLabel_, lv_color_make(255, 255, 255), 0);
+    lv_obj_set_style_text_font(statsLabel_, &lv_font_montserrat_14, 0);
+
+    chart_ = lv_chart_create(panel_);
+    applyCleanStyle(chart_);
+    lv_obj_set_size(chart_, DISP_WIDTH, PANEL_HEIGHT - 36);
+    lv_obj_align(chart_, LV_ALIGN_BOTTOM_MID, 0, 0);
+    lv_obj_set_style_bg_color(chart_, lv_color_make(24, 24, 24), 0);
+    lv_obj_set_style_border_width(chart_, 0, 0);
+    lv_obj_set_style_radius(chart_, 0, 0);
+    lv_obj_set_style_line_width(chart_, 1, LV_PART_ITEMS);
+    lv_obj_set_style_size(chart_, 0, 0, LV_PART_INDICATOR);
+    lv_chart_set_type(chart_, LV_CHART_TYPE_LINE);
+    lv_chart_set_div_line_count(chart_, 0, 0);
+    lv_chart_set_point_count(chart_, CHART_POINTS);
+    lv_chart_set_update_mode(chart_, LV_CHART_UPDATE_MODE_SHIFT);
+    lv_chart_set_axis_range(chart_, LV_CHART_AXIS_PRIMARY_Y, 0, CHART_MAX);
+
+    // Display has swapped R/B channels, colors are given as the panel shows them
+    series_[0] = lv_chart_add_series(chart_, lv_color_make(0, 255, 0), LV_CHART_AXIS_PRIMARY_Y);     // logic
+    series_[1] = lv_chart_add_series(chart_, lv_color_make(0, 200, 255), LV_CHART_AXIS_PRIMARY_Y);   // render
+    series_[2] = lv_chart_add_series(chart_, lv_color_make(255, 128, 0), LV_CHART_AXIS_PRIMARY_Y);   // flush
+    series_[3] = lv_chart_add_series(chart_, lv_color_make(255, 0, 255), LV_CHART_AXIS_PRIMARY_Y);   // wait
+
+    frame_profile_t skip;
+    cursor_ = 0;
+    while (frame_profiler_read(&skip, 1, &cursor_) > 0) {
+    }
+
+    refreshTimer_ = lv_timer_create(refreshTimerCallback, REFRESH_MS, this);
+    refresh();
+}
+
+void ProfilerOverlay::destroy() {
+    if (refreshTimer_) {
+        lv_timer_delete(refreshTimer_);
+        refreshTimer_ = nullptr;
+    }
+
+    if (panel_) {
+        lv_obj_delete(panel_);
+        panel_ = nullptr;
+        chart_ = nullptr;
+        statsLabel_ = nullptr;
+        for (auto& series : series_) {
+            series = nullptr;
+        }
+    }
+}
+
+static int32_t toChartValue(uint32_t us) {
+    int32_t value = static_cast<int32_t>(us / 100);
+    return value > CHART_MAX ? CHART_MAX : value;
+}
+
+void ProfilerOverlay::refresh() {
+    frame_profile_t frames[CHART_POINTS];
+    uint32_t count = frame_profiler_read(frames, CHART_POINTS, &cursor_);
+
+    for (uint32_t i = 0; i < count; i++) {
+        lv_chart_set_next_value(chart_, series_[0], toChartValue(frames[i].game_us));
+        lv_chart_set_next_value(chart_, series_[1], toChartValue(frames[i].render_us));
+        lv_chart_set_next_value(chart_, series_[2], toChartValue(frames[i].flush_us));
+        lv_chart_set_next_value(chart_, series_[3], toChartValue(frames[i].wait_us));
+    }
+    if (count > 0) {
+        lv_chart_refresh(chart_);
+    }
+
+    frame_profiler_summary_t summary;
+    frame_profiler_get_summary(&summary);
+
+    render_stats_t frame;
+    render_stats_get_last_frame(&frame);
+
+    char text[160];
+    snprintf(text, sizeof(text), "%lu.%lu FPS  L%lu R%lu F%lu W%lu us  C0 %u%% C1 %u%%\n"
+             "inv %lu/%lupx  flush %lu/%lupx  %lluB  del %lu",
+             summary.fps_x10 / 10, summary.fps_x10 % 10,
+             summary.avg.game_us, summary.avg.render_us,
+             summary.avg.flush_us, summary.avg.wait_us,
+             summary.cpu_load[0], summary.cpu_load[1],
+             frame.inv_areas, frame.inv_pixels,
+             frame.flush_calls, frame.redrawn_pixels, frame.tx_bytes,
+             DeferredDeleter::instance().pendingObjects());
+    lv_label_set_text(statsLabel_, text);
+}
+
+void ProfilerOverlay::refreshTimerCallback(lv_timer_t* timer) {
+    auto* overlay = static_cast<ProfilerOverlay*>(lv_timer_get_user_data(timer));
+    if (overlay && overlay->visible()) {
+        overlay->refresh();
+    }
+}
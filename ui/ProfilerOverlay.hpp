@@ -0,0 +1,36 @@
+#pragma once
+
+#include "lvgl.h"
+#include "frame_profiler.h"
+#include "render_stats.h"
+
+// Frame budget overlay on the top layer. Occupies a fixed strip at the bottom of
+// the display so its own redraw stays small and predictable.
+class ProfilerOverlay {
+public:
+    static ProfilerOverlay& instance();
+
+    void toggle();
+    bool visible() const { return panel_ != nullptr; }
+
+private:
+    ProfilerOverlay() = default;
+
+    static const int PANEL_HEIGHT = 88;
+    static const int CHART_POINTS = 48;
+    static const int SERIES_COUNT = 4;
+    static const int REFRESH_MS = 200;
+
+    void create();
+    void destroy();
+    void refresh();
+
+    static void refreshTimerCallback(lv_timer_t* timer);
+
+    lv_obj_t* panel_ = nullptr;
+    lv_obj_t* chart_ = nullptr;
+    lv_obj_t* statsLabel_ = nullptr;
+    lv_chart_series_t* series_[SERIES_COUNT] = {nullptr};
+    lv_timer_t* refreshTimer_ = nullptr;
+    uint32_t cursor_ = 0;
+};
@@ -0,0 +1,102 @@
+#include "ScreenSnapshot.hpp"
+#include "lvgl_helper.hpp"
+#include "app_config.h"
+#include "esp_heap_caps.h"
+#include "esp_log.h"
+
+static const char *TAG = "ScreenSnapshot";
+
+static const lv_color_format_t SNAPSHOT_FORMAT = LV_COLOR_FORMAT_RGB565;
+
+ScreenSnapshot::~ScreenSnapshot() {
+    if (data_) {
+        heap_caps_free(data_);
+    }
+}
+
+bool ScreenSnapshot::allocate() {
+    uint32_t stride = lv_draw_buf_width_to_stride(DISP_WIDTH, SNAPSHOT_FORMAT);
+    uint32_t size = stride * DISP_HEIGHT;
+
+    data_ = heap_caps_aligned_alloc(LV_DRAW_BUF_ALIGN, size, MALLOC_CAP_SPIRAM);
+    if (!data_) {
+        ESP_LOGE(TAG, "No PSRAM for a %lu byte snapshot", size);
+        return false;
+    }
+
+    if (lv_draw_buf_init(&buf_, DISP_WIDTH, DISP_HEIGHT, SNAPSHOT_FORMAT, stride, data_, size) != LV_RESULT_OK) {
+        heap_caps_free(data_);
+        data_ = nullptr;
+        return false;
+    }
+    return true;
+}
+
+bool ScreenSnapshot::capture(lv_obj_t* obj) {
+    valid_ = false;
+    if (!obj || (!data_ && !allocate())) {
+        return false;
+    }
+
+    // Reshapes buf_ to the size of obj, which never exceeds the display
+    valid_ = lv_snapshot_take_to_draw_buf(obj, SNAPSHOT_FORMAT, &buf_) == LV_RESULT_OK;
+    if (!valid_) {
+        ESP_LOGW(TAG, "Snapshot failed");
+        return false;
+    }
+    splitColumns();
+    // Same buffer, new pixels
+    dropCached();
+    return true;
+}
+
+// Column descriptors share the rows of the full buffer through its stride
+void ScreenSnapshot::splitColumns() {
+    uint32_t width = buf_.header.w;
+    uint32_t pixelSize = lv_color_format_get_size(SNAPSHOT_FORMAT);
+
+    for (int i = 0; i < COLUMNS; i++) {
+        uint32_t x0 = width * i / COLUMNS;
+        uint32_t x1 = width * (i + 1) / COLUMNS;
+        uint32_t offset = x0 * pixelSize;
+
+        columns_[i].header = buf_.header;
+        columns_[i].header.w = x1 - x0;
+        columns_[i].data = buf_.data + offset;
+        columns_[i].data_size = buf_.header.stride * buf_.header.h - offset;
+    }
+}
+
+void ScreenSnapshot::dropCached() {
+    lv_image_cache_drop(&buf_);
+    for (int i = 0; i < COLUMNS; i++) {
+        lv_image_cache_drop(&columns_[i]);
+    }
+}
+
+lv_obj_t* ScreenSnapshot::createView(lv_obj_t* parent) const {
+    lv_obj_t* view = createCleanObject(parent);
+    lv_obj_set_style_bg_opa(view, LV_OPA_TRANSP, 0);
+    lv_obj_set_style_border_width(view, 0, 0);
+    lv_obj_set_style_radius(view, 0, 0);
+    lv_obj_set_size(view, DISP_WIDTH, DISP_HEIGHT);
+
+    for (int i = 0; i < COLUMNS; i++) {
+        lv_obj_t* column = lv_image_create(view);
+        applyCleanStyle(column);
+    }
+    if (valid_) {
+        bindView(view);
+    }
+    return view;
+}
+
+void ScreenSnapshot::bindView(lv_obj_t* view) const {
+    int32_t x = 0;
+    for (int i = 0; i < COLUMNS; i++) {
+        lv_obj_t* column = lv_obj_get_child(view, i);
+        lv_image_set_src(column, &columns_[i]);
+        lv_obj_set_pos(column, x, 0);
+        x += columns_[i].header.w;
+    }
+}
@@ -0,0 +1,43 @@
+#pragma once
+
+#include "lvgl.h"
+
+// Full screen RGB565 image of an object tree, rendered with lv_snapshot into a
+// buffer in PSRAM that is allocated on first use and kept. Can be shown with a
+// view of a few image objects instead of rendering the tree again.
+class ScreenSnapshot {
+public:
+    // One column per software draw unit. Every column is a separate draw task over
+    // each band LVGL renders, so the draw units blit them in parallel.
+    static const int COLUMNS = LV_DRAW_SW_DRAW_UNIT_CNT;
+
+    ScreenSnapshot() = default;
+    ~ScreenSnapshot();
+
+    ScreenSnapshot(const ScreenSnapshot&) = delete;
+    ScreenSnapshot& operator=(const ScreenSnapshot&) = delete;
+
+    // Renders obj now, on the LVGL task. False if there is no buffer or the render failed.
+    bool capture(lv_obj_t* obj);
+
+    bool valid() const { return valid_; }
+    void invalidate() { valid_ = false; }
+
+    // Transparent container with COLUMNS images side by side. Shows the snapshot
+    // if one is valid, otherwise bindView() once it is.
+    lv_obj_t* createView(lv_obj_t* parent) const;
+    void bindView(lv_obj_t* view) const;
+
+    // Pixels for in-place post-processing, call dropCached() afterwards
+    lv_draw_buf_t* buffer() { return &buf_; }
+    void dropCached();
+
+private:
+    bool allocate();
+    void splitColumns();
+
+    lv_draw_buf_t buf_ = {};
+    lv_image_dsc_t columns_[COLUMNS] = {};
+    void* data_ = nullptr;
+    bool valid_ = false;
+};
@@ -0,0 +1,63 @@
+#include "ScreenTransition.hpp"
+#include "lvgl_helper.hpp"
+#include "app_config.h"
+#include "esp_log.h"
+
+static const char *TAG = "ScreenTransition";
+
+ScreenTransition& ScreenTransition::instance() {
+    static ScreenTransition inst;
+    return inst;
+}
+
+void ScreenTransition::slideOut(lv_obj_t* outgoing) {
+    if (!SCREEN_SNAPSHOTS) return;
+
+    // A transition still running is cut short, its image is about to be replaced
+    finish();
+
+    if (!snapshot_.capture(outgoing)) {
+        return;
+    }
+
+    // Top layer, below the profiler overlay
+    image_ = snapshot_.createView(lv_layer_top());
+    lv_obj_set_pos(image_, 0, 0);
+    lv_obj_move_background(image_);
+
+    lv_anim_t anim;
+    lv_anim_init(&anim);
+    lv_anim_set_var(&anim, this);
+    lv_anim_set_exec_cb(&anim, animExec);
+    lv_anim_set_completed_cb(&anim, animCompleted);
+    lv_anim_set_values(&anim, 0, DISP_WIDTH);
+    lv_anim_set_duration(&anim, TRANSITION_MS);
+    lv_anim_set_path_cb(&anim, lv_anim_path_ease_in);
+    lv_anim_start(&anim);
+
+    ESP_LOGI(TAG, "Transition started");
+}
+
+void ScreenTransition::finish() {
+    if (!image_) return;
+
+    lv_anim_delete(this, animExec);
+    lv_obj_delete(image_);
+    image_ = nullptr;
+}
+
+void ScreenTransition::animExec(void* var, int32_t value) {
+    auto* transition = static_cast<ScreenTransition*>(var);
+    if (transition->image_) {
+        lv_obj_set_x(transition->image_, value);
+    }
+}
+
+// The animation is already unlinked here, only the image is left to delete
+void ScreenTransition::animCompleted(lv_anim_t* anim) {
+    auto* transition = static_cast<ScreenTransition*>(anim->var);
+    if (transition->image_) {
+        lv_obj_delete(transition->image_);
+        transition->image_ = nullptr;
+    }
+}
@@ -0,0 +1,26 @@
+#pragma once
+
+#include "lvgl.h"
+#include "ScreenSnapshot.hpp"
+
+// Slides the image of the outgoing screen off to the right over whatever screen
+// is loaded next. The outgoing tree is captured once and can be deleted right
+// away, each frame of the transition is a blit of the cached image.
+class ScreenTransition {
+public:
+    static ScreenTransition& instance();
+
+    // Call while outgoing is still the active screen, then load the next one
+    void slideOut(lv_obj_t* outgoing);
+
+private:
+    ScreenTransition() = default;
+
+    void finish();
+
+    static void animExec(void* var, int32_t value);
+    static void animCompleted(lv_anim_t* anim);
+
+    ScreenSnapshot snapshot_;
+    lv_obj_t* image_ = nullptr;
+};
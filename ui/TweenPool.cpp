@@ -0,0 +1,144 @@
+#include "TweenPool.hpp"
+
+// Fixed point progress, 0 at the start and SCALE at the end
+static const int32_t SCALE = 1024;
+
+// Pools with running tweens, the display refresh is fast while any has
+static int s_runningPools = 0;
+
+TweenPool::TweenPool(int capacity)
+  : capacity_(capacity)
+{
+    tweens_.reserve(capacity);
+}
+
+TweenPool::~TweenPool() {
+    clear();
+}
+
+void TweenPool::setIdleCallback(IdleCallback callback, void* userData) {
+    idleCallback_ = callback;
+    idleUserData_ = userData;
+}
+
+void TweenPool::start(lv_obj_t* obj, const lv_area_t& from, const lv_area_t& to, uint32_t durationMs, Path path) {
+    Tween tween = {obj, from, to, lv_tick_get(), durationMs ? durationMs : 1, path};
+
+    // An object has at most one tween, a new one replaces it even when the pool is full
+    Tween* slot = nullptr;
+    for (Tween& running : tweens_) {
+        if (running.obj == obj) {
+            slot = &running;
+            break;
+        }
+    }
+    if (!slot) {
+        if (tweens_.size() >= capacity_) {
+            return;
+        }
+        tweens_.push_back(tween);
+        slot = &tweens_.back();
+    } else {
+        *slot = tween;
+    }
+    apply(*slot, 0);
+
+    if (!timer_) {
+        timer_ = lv_timer_create(timerCallback, FRAME_MS, this);
+    } else {
+        lv_timer_resume(timer_);
+    }
+    setRunning(true);
+}
+
+void TweenPool::finishAll() {
+    for (const Tween& tween : tweens_) {
+        apply(tween, SCALE);
+    }
+    tweens_.clear();
+    if (timer_) {
+        lv_timer_pause(timer_);
+    }
+    setRunning(false);
+}
+
+void TweenPool::clear() {
+    tweens_.clear();
+    if (timer_) {
+        lv_timer_delete(timer_);
+        timer_ = nullptr;
+    }
+    setRunning(false);
+}
+
+// The display refresh timer runs at LV_DEF_REFR_PERIOD, slower than FRAME_MS.
+// It is shortened for as long as any pool has tweens running.
+void TweenPool::setRunning(bool running) {
+    if (running == running_) {
+        return;
+    }
+    running_ = running;
+
+    s_runningPools += running ? 1 : -1;
+    if (s_runningPools != (running ? 1 : 0)) {
+        return;
+    }
+
+    lv_display_t* display = lv_display_get_default();
+    lv_timer_t* refresh = display ? lv_display_get_refr_timer(display) : nullptr;
+    if (refresh) {
+        lv_timer_set_period(refresh, running ? FRAME_MS : LV_DEF_REFR_PERIOD);
+    }
+}
+
+void TweenPool::advance() {
+    uint32_t now = lv_tick_get();
+
+    // Swap-remove finished tweens, order does not matter
+    for (size_t i = 0; i < tweens_.size();) {
+        Tween& tween = tweens_[i];
+        uint32_t elapsed = lv_tick_diff(now, tween.start);
+        if (elapsed >= tween.duration) {
+            apply(tween, SCALE);
+            tween = tweens_.back();
+            tweens_.pop_back();
+        } else {
+            apply(tween, static_cast<int32_t>(elapsed * SCALE / tween.duration));
+            i++;
+        }
+    }
+
+    if (tweens_.empty()) {
+        lv_timer_pause(timer_);
+        setRunning(false);
+        if (idleCallback_) {
+            idleCallback_(idleUserData_);
+        }
+    }
+}
+
+void TweenPool::apply(const Tween& tween, int32_t progress) {
+    int32_t f;
+    if (tween.path == BUMP) {
+        // Triangle out and back, ends on from
+        f = progress < SCALE / 2 ? progress * 2 : (SCALE - progress) * 2;
+    } else {
+        // Quadratic ease-out: 1 - (1 - t)^2
+        int32_t rest = SCALE - progress;
+        f = SCALE - rest * rest / SCALE;
+    }
+
+    auto lerp = [f](int32_t a, int32_t b) { return a + (b - a) * f / SCALE; };
+    int32_t x1 = lerp(tween.from.x1, tween.to.x1);
+    int32_t y1 = lerp(tween.from.y1, tween.to.y1);
+    int32_t x2 = lerp(tween.from.x2, tween.to.x2);
+    int32_t y2 = lerp(tween.from.y2, tween.to.y2);
+
+    lv_obj_set_pos(tween.obj, x1, y1);
+    lv_obj_set_size(tween.obj, x2 - x1 + 1, y2 - y1 + 1);
+}
+
+void TweenPool::timerCallback(lv_timer_t* timer) {
+    auto* pool = static_cast<TweenPool*>(lv_timer_get_user_data(timer));
+    pool->advance();
+}
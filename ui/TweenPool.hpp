@@ -0,0 +1,66 @@
+#pragma once
+
+#include "lvgl.h"
+#include <cstdint>
+#include <vector>
+
+// Batched geometry animation. Every running tween moves and resizes its object
+// from one area to another, all of them advanced by a single LVGL timer per frame
+// instead of an lv_anim each. Slots are reserved up front, starting a tween never
+// allocates, and the timer is paused while nothing runs. While tweens run the
+// display refreshes every FRAME_MS instead of LV_DEF_REFR_PERIOD, so every step
+// is drawn.
+class TweenPool {
+public:
+    enum Path {
+        EASE_OUT,       // from -> to, decelerating
+        BUMP            // from -> to -> from, for pops
+    };
+
+    // Called when the last running tween has finished on its own
+    using IdleCallback = void (*)(void* userData);
+
+    explicit TweenPool(int capacity);
+    ~TweenPool();
+
+    TweenPool(const TweenPool&) = delete;
+    TweenPool& operator=(const TweenPool&) = delete;
+
+    void setIdleCallback(IdleCallback callback, void* userData);
+
+    // Areas are relative to the parent, as in lv_obj_set_pos(). Replaces the tween
+    // of obj if it has one, otherwise ignored when full.
+    void start(lv_obj_t* obj, const lv_area_t& from, const lv_area_t& to, uint32_t durationMs, Path path);
+
+    // Puts every object at its end area without the idle callback
+    void finishAll();
+
+    // Deletes the timer and forgets all tweens, before the objects are deleted
+    void clear();
+
+    bool active() const { return !tweens_.empty(); }
+
+private:
+    static const uint32_t FRAME_MS = 16;
+
+    struct Tween {
+        lv_obj_t* obj;
+        lv_area_t from;
+        lv_area_t to;
+        uint32_t start;
+        uint32_t duration;
+        Path path;
+    };
+
+    void setRunning(bool running);
+    void advance();
+    static void apply(const Tween& tween, int32_t progress);
+    static void timerCallback(lv_timer_t* timer);
+
+    std::vector<Tween> tweens_;
+    size_t capacity_;
+    lv_timer_t* timer_ = nullptr;
+    bool running_ = false;
+    IdleCallback idleCallback_ = nullptr;
+    void* idleUserData_ = nullptr;
+};